@@ -0,0 +1,203 @@
+// ============================================================================
+// BinaryRecord.hpp
+// ============================================================================
+//
+// What this file does:
+//   Defines the fixed-layout binary form of a partial unfolding record and
+//   writes it, as an alternative to the JSONL text form.
+//
+// このファイルの役割:
+//   部分展開図レコードの固定レイアウトのバイナリ形式を定義し、JSONL テキスト形式の
+//   代わりにその形式で書き込む。
+//
+// Responsibility in the project:
+//   - Defines the record layout shared by C++ and Python readers
+//   - Writes records with the same rounding as JsonUtil::writeJsonlRecord
+//   - Converts a binary record back to its JSONL line
+//   - Does NOT transport records (see ShmRing.hpp)
+//
+// プロジェクト内での責務:
+//   - C++ と Python の読み手が共有するレコードレイアウトを定義
+//   - JsonUtil::writeJsonlRecord と同じ丸めでレコードを書き込む
+//   - バイナリレコードを JSONL の行に戻す
+//   - レコードの転送は担当しない（ShmRing.hpp を参照）
+//
+// Phase 1 における位置づけ:
+//   Record format of the shared-memory handoff (`rotunfold --shm-ring`).
+//   Values are stored already rounded and normalized, so converting a record
+//   back to JSONL reproduces the raw.jsonl line byte for byte; consumers read
+//   fields in place without parsing text.
+//   Phase 1では、共有メモリによる受け渡し（`rotunfold --shm-ring`）のレコード形式。
+//   値は丸め・正規化済みで格納されるため、レコードを JSONL に戻すと raw.jsonl の
+//   行をバイト単位で再現する。読み手はテキストを解析せずにフィールドをその場で読む。
+//
+// Layout (native byte order, little-endian on all supported platforms):
+//   RecordHeader (24 bytes)
+//     uint32 size        Size of the whole record in bytes (24 + 40 * num_faces)
+//     int32  base_face
+//     int32  base_edge
+//     uint16 num_faces
+//     uint8  flags       FLAG_SYMMETRIC_USED | FLAG_HAS_SLACK
+//     uint8  reserved    0
+//     double circle_gap  Endpoint slack (0.0 unless FLAG_HAS_SLACK)
+//   FaceEntry (40 bytes) * num_faces
+//     int32  face_id
+//     int32  gon
+//     int32  edge_id
+//     int32  reserved    0
+//     double x, y, angle_deg
+//
+// ============================================================================
+
+#ifndef REORG_BINARY_RECORD_HPP
+#define REORG_BINARY_RECORD_HPP
+
+#include "UnfoldedFace.hpp"
+#include "GeometryUtil.hpp"
+#include "JsonUtil.hpp"
+#include "SearchOptions.hpp"
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace BinaryRecord {
+
+const std::uint8_t FLAG_SYMMETRIC_USED = 1;  // symmetric_used is true / symmetric_used が true
+const std::uint8_t FLAG_HAS_SLACK = 2;       // circle_gap is present / circle_gap を持つ
+
+// ----------------------------------------------------------------------------
+// RecordHeader / FaceEntry
+// ----------------------------------------------------------------------------
+//
+// In-place views of a record. Records are 8-byte aligned in every buffer
+// they are written to, so the fields can be read directly.
+// レコードをその場で参照するための構造体。レコードは書き込まれるどのバッファでも
+// 8バイト境界に置かれるため、フィールドを直接読める。
+//
+// ----------------------------------------------------------------------------
+struct RecordHeader {
+    std::uint32_t size;
+    std::int32_t base_face;
+    std::int32_t base_edge;
+    std::uint16_t num_faces;
+    std::uint8_t flags;
+    std::uint8_t reserved;
+    double circle_gap;
+};
+
+struct FaceEntry {
+    std::int32_t face_id;
+    std::int32_t gon;
+    std::int32_t edge_id;
+    std::int32_t reserved;
+    double x;
+    double y;
+    double angle_deg;
+};
+
+static_assert(sizeof(RecordHeader) == 24, "RecordHeader layout is part of the format");
+static_assert(sizeof(FaceEntry) == 40, "FaceEntry layout is part of the format");
+
+// Returns the faces that follow a record header
+// レコードヘッダに続く面を返す
+inline const FaceEntry* faces(const RecordHeader* header) {
+    return reinterpret_cast<const FaceEntry*>(header + 1);
+}
+
+// ----------------------------------------------------------------------------
+// writeRecord
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   out               : Output stream to write the record
+//   base_face         : ID of the base face
+//   base_edge         : ID of the base edge
+//   symmetric_used    : Whether symmetry pruning was enabled for this unfolding
+//   partial_unfolding : Vector of UnfoldedFace representing the partial unfolding path
+//   slack             : Endpoint slack to include, or nullptr to omit it
+//
+// 入力:
+//   out               : レコードを書き込む出力ストリーム
+//   base_face         : 基準面のID
+//   base_edge         : 基準辺のID
+//   symmetric_used    : この展開図で対称性枝刈りが有効だったか
+//   partial_unfolding : 部分展開図のパスを表す UnfoldedFace のベクター
+//   slack             : 含める端点スラック。省略する場合は nullptr
+//
+// Guarantee:
+//   - Numeric values are rounded and normalized exactly as in
+//     JsonUtil::writeJsonlRecord
+//   - The record size is a multiple of 8 bytes
+//
+// 保証:
+//   - 数値は JsonUtil::writeJsonlRecord と全く同じように丸め・正規化される
+//   - レコードサイズは8バイトの倍数
+//
+// ----------------------------------------------------------------------------
+inline void writeRecord(
+    std::ostream& out,
+    int base_face,
+    int base_edge,
+    bool symmetric_used,
+    const std::vector<UnfoldedFace>& partial_unfolding,
+    const EndpointSlack* slack = nullptr)
+{
+    RecordHeader header = {};
+    header.size = static_cast<std::uint32_t>(sizeof(RecordHeader)
+                                             + sizeof(FaceEntry) * partial_unfolding.size());
+    header.base_face = base_face;
+    header.base_edge = base_edge;
+    header.num_faces = static_cast<std::uint16_t>(partial_unfolding.size());
+    header.flags = (symmetric_used ? FLAG_SYMMETRIC_USED : 0) | (slack ? FLAG_HAS_SLACK : 0);
+    header.circle_gap = slack ? JsonUtil::roundTo6Decimals(slack->circle_gap) : 0.0;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const auto& f : partial_unfolding) {
+        double normalized_angle = f.angle;
+        GeometryUtil::normalizeAngle(normalized_angle);
+
+        FaceEntry entry = {};
+        entry.face_id = f.face_id;
+        entry.gon = f.gon;
+        entry.edge_id = f.edge_id;
+        entry.x = JsonUtil::roundTo6Decimals(f.x);
+        entry.y = JsonUtil::roundTo6Decimals(f.y);
+        entry.angle_deg = JsonUtil::roundTo6Decimals(normalized_angle);
+        out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+}
+
+// ----------------------------------------------------------------------------
+// writeJsonl
+// ----------------------------------------------------------------------------
+//
+// Writes the JSONL line of a binary record (identical to the line rotunfold
+// writes without --shm-ring).
+// バイナリレコードの JSONL 行を書き込む（--shm-ring なしで rotunfold が書き込む
+// 行と同一）。
+//
+// ----------------------------------------------------------------------------
+inline void writeJsonl(std::ostream& out, const RecordHeader* header) {
+    // Stored values are already rounded, and rounding them again is exact,
+    // except that it turns -0.0 into 0.0; a tiny negative value rounds back
+    // to -0.0 and keeps the "-0.000000" of the original line
+    // 格納値は丸め済みで、再度丸めても変わらないが、-0.0 は 0.0 になる。
+    // 微小な負の値は -0.0 に丸められ、元の行の "-0.000000" を保つ
+    auto unround = [](double v) { return (v == 0.0 && std::signbit(v)) ? -1e-12 : v; };
+
+    std::vector<UnfoldedFace> path(header->num_faces);
+    const FaceEntry* entries = faces(header);
+    for (size_t i = 0; i < path.size(); ++i) {
+        path[i] = {entries[i].face_id, entries[i].gon, entries[i].edge_id,
+                   unround(entries[i].x), unround(entries[i].y), unround(entries[i].angle_deg)};
+    }
+    EndpointSlack slack = {unround(header->circle_gap)};
+    JsonUtil::writeJsonlRecord(out, header->base_face, header->base_edge,
+                               (header->flags & FLAG_SYMMETRIC_USED) != 0, path,
+                               (header->flags & FLAG_HAS_SLACK) ? &slack : nullptr);
+}
+
+}  // namespace BinaryRecord
+
+#endif  // REORG_BINARY_RECORD_HPP
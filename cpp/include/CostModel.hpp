@@ -0,0 +1,305 @@
+// ============================================================================
+// CostModel.hpp
+// ============================================================================
+//
+// What this file does:
+//   Persists per-root search costs (node counts and wall times) from previous
+//   runs in a small JSON file, keyed by the content of the polyhedron and the
+//   search options that affect the cost.
+//
+// このファイルの役割:
+//   過去の実行における root pair ごとの探索コスト（ノード数と経過時間）を、
+//   多面体の内容とコストに影響する探索オプションをキーとして、
+//   小さな JSON ファイルに保存する。
+//
+// Responsibility in the project:
+//   - Computes the cost-model key for a polyhedron and search options
+//   - Loads the recorded costs for that key
+//   - Stores the costs measured in the current run
+//   - Does NOT schedule work or run the search
+//
+// プロジェクト内での責務:
+//   - 多面体と探索オプションからコストモデルのキーを計算
+//   - そのキーに対応する記録済みコストを読み込む
+//   - 今回の実行で計測したコストを保存
+//   - 作業のスケジューリングや探索そのものは担当しない
+//
+// Phase 1 における位置づけ:
+//   Run history used to order and split work across worker threads and to
+//   predict the total runtime. Missing or unreadable history is not an error;
+//   the caller falls back to probing.
+//   Phase 1では、ワーカースレッド間での作業の順序付け・分割、および総実行時間の
+//   予測に使用される実行履歴。履歴の欠落や読み込み失敗はエラーではなく、
+//   呼び出し側はプローブにフォールバックする。
+//
+// File format (cost_model.json):
+//   {
+//     "schema_version": 1,
+//     "record_type": "cost_model",
+//     "entries": {
+//       "<key>": {
+//         "poly_name": string,
+//         "roots": [
+//           {"base_face": int, "base_edge": int, "nodes": int, "seconds": float},
+//           ...
+//         ]
+//       },
+//       ...
+//     }
+//   }
+//
+// ============================================================================
+
+#ifndef REORG_COST_MODEL_HPP
+#define REORG_COST_MODEL_HPP
+
+#include "HashUtil.hpp"
+#include "SearchOptions.hpp"
+#include "json.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace CostModel {
+
+using json = nlohmann::json;
+
+// ============================================================================
+// RootCost
+// ============================================================================
+//
+// Measured cost of the search from a single root pair.
+// 1つの root pair からの探索の計測コスト。
+//
+// ============================================================================
+struct RootCost {
+    int base_face;        // ID of the base face / 基準面のID
+    int base_edge;        // ID of the base edge / 基準辺のID
+    long long nodes;      // Number of search nodes visited / 訪問した探索ノード数
+    double seconds;       // Wall time spent on this root / この root に要した経過時間
+};
+
+// ----------------------------------------------------------------------------
+// makeKey
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   polyhedron_path : Path to the polyhedron.json file
+//   symmetric       : Whether symmetry pruning is enabled
+//   options         : Search options of the run
+//   key             : Reference to store the resulting key
+//
+// 入力:
+//   polyhedron_path : polyhedron.json ファイルへのパス
+//   symmetric       : 対称性枝刈りが有効か
+//   options         : 実行の探索オプション
+//   key             : 結果のキーを格納する参照
+//
+// Output:
+//   Returns true on success, false if polyhedron.json cannot be read.
+//   The key is the FNV-1a hash of the file contents, extended with the
+//   symmetry flag and the emit tolerance (both change the search tree).
+//
+// 出力:
+//   成功時は true、polyhedron.json を読めない場合は false を返す。
+//   キーはファイル内容の FNV-1a ハッシュに、対称性フラグと出力許容値
+//   （いずれも探索木を変える）を加えたものである。
+//
+// ----------------------------------------------------------------------------
+inline bool makeKey(const std::string& polyhedron_path,
+                    bool symmetric,
+                    const SearchOptions& options,
+                    std::string& key) {
+    std::uint64_t hash;
+    if (!HashUtil::hashFile(polyhedron_path, hash)) {
+        return false;
+    }
+
+    std::ostringstream oss;
+    oss << HashUtil::toHex(hash)
+        << "/sym=" << (symmetric ? "on" : "off")
+        << "/emit=" << options.emit_buffer;
+    key = oss.str();
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// loadRootCosts
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   model_path : Path to the cost model file
+//   key        : Cost-model key (see makeKey)
+//   costs      : Map to be filled, keyed by (base_face, base_edge)
+//
+// 入力:
+//   model_path : コストモデルファイルへのパス
+//   key        : コストモデルのキー（makeKey を参照）
+//   costs      : (base_face, base_edge) をキーとして埋められるマップ
+//
+// Output:
+//   Returns true if an entry for the key was found, false otherwise.
+//
+// 出力:
+//   キーに対応するエントリが見つかった場合 true、それ以外は false を返す。
+//
+// Guarantee:
+//   - A missing file or a missing key is not reported as an error
+//   - A malformed file produces a warning on std::cerr and returns false
+//
+// 保証:
+//   - ファイルやキーが存在しない場合はエラーとして報告しない
+//   - 不正な形式のファイルは std::cerr に警告を出して false を返す
+//
+// ----------------------------------------------------------------------------
+inline bool loadRootCosts(const std::string& model_path,
+                          const std::string& key,
+                          std::map<std::pair<int, int>, RootCost>& costs) {
+    std::ifstream file(model_path);
+    if (!file) {
+        return false;
+    }
+
+    try {
+        json j;
+        file >> j;
+        if (!j.contains("entries") || !j["entries"].contains(key)) {
+            return false;
+        }
+        for (const auto& root : j["entries"][key]["roots"]) {
+            RootCost cost = {
+                root["base_face"].get<int>(),
+                root["base_edge"].get<int>(),
+                root["nodes"].get<long long>(),
+                root["seconds"].get<double>()
+            };
+            costs[{cost.base_face, cost.base_edge}] = cost;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: Ignoring unreadable cost model " << model_path
+                  << ": " << e.what() << "\n";
+        costs.clear();
+        return false;
+    }
+
+    return !costs.empty();
+}
+
+// ----------------------------------------------------------------------------
+// saveRootCosts
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   model_path : Path to the cost model file
+//   key        : Cost-model key (see makeKey)
+//   poly_name  : Polyhedron name (informational only)
+//   costs      : Costs measured in this run, in root-pair order
+//
+// 入力:
+//   model_path : コストモデルファイルへのパス
+//   key        : コストモデルのキー（makeKey を参照）
+//   poly_name  : 多面体名（情報用のみ）
+//   costs      : 今回の実行で計測したコスト（root pair の順）
+//
+// Output:
+//   Returns true on success, false on failure.
+//
+// 出力:
+//   成功時は true、失敗時は false を返す。
+//
+// Guarantee:
+//   - Replaces the entry for key; entries for other keys are preserved
+//   - Writes to a uniquely named temporary file in the same directory and
+//     renames it, so readers never see a partially written model and
+//     concurrent runs never write to the same file
+//   - On failure, a warning is written to std::cerr
+//
+// 保証:
+//   - key のエントリを置き換え、他のキーのエントリは保持する
+//   - 同じディレクトリ内の一意な名前の一時ファイルに書き込んでからリネームする
+//     ため、書きかけのモデルが読まれることはなく、同時に実行される複数の実行が
+//     同じファイルに書き込むこともない
+//   - 失敗時は std::cerr に警告を書き込む
+//
+// ----------------------------------------------------------------------------
+inline bool saveRootCosts(const std::string& model_path,
+                          const std::string& key,
+                          const std::string& poly_name,
+                          const std::vector<RootCost>& costs) {
+    json j;
+    {
+        std::ifstream file(model_path);
+        if (file) {
+            try {
+                file >> j;
+            } catch (...) {
+                j = json();
+            }
+        }
+    }
+    if (!j.is_object() || !j.contains("entries") || !j["entries"].is_object()) {
+        j = json::object();
+        j["entries"] = json::object();
+    }
+    j["schema_version"] = 1;
+    j["record_type"] = "cost_model";
+
+    json roots = json::array();
+    for (const auto& cost : costs) {
+        roots.push_back({
+            {"base_face", cost.base_face},
+            {"base_edge", cost.base_edge},
+            {"nodes", cost.nodes},
+            {"seconds", cost.seconds}
+        });
+    }
+    j["entries"][key] = {{"poly_name", poly_name}, {"roots", roots}};
+
+    // The model is shared by concurrent runs, so each run writes its own
+    // temporary file next to it
+    // モデルは同時に実行される複数の実行で共有されるため、各実行はその隣に
+    // 自分専用の一時ファイルを書き込む
+    std::string tmp_path = model_path + ".XXXXXX";
+    int fd = ::mkstemp(&tmp_path[0]);
+    if (fd < 0) {
+        std::cerr << "Warning: Cannot write cost model: " << tmp_path << "\n";
+        return false;
+    }
+    ::fchmod(fd, 0644);
+    const std::string text = j.dump(1) + "\n";
+    bool written = true;
+    for (size_t pos = 0; pos < text.size(); ) {
+        ssize_t n = ::write(fd, text.data() + pos, text.size() - pos);
+        if (n <= 0) {
+            written = false;
+            break;
+        }
+        pos += static_cast<size_t>(n);
+    }
+    if (::close(fd) != 0) written = false;
+    if (!written) {
+        std::cerr << "Warning: Cannot write cost model: " << tmp_path << "\n";
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    if (std::rename(tmp_path.c_str(), model_path.c_str()) != 0) {
+        std::cerr << "Warning: Cannot replace cost model: " << model_path << "\n";
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+}  // namespace CostModel
+
+#endif  // REORG_COST_MODEL_HPP
@@ -0,0 +1,425 @@
+// ============================================================================
+// CpuTopology.hpp
+// ============================================================================
+//
+// What this file does:
+//   Reads the CPUs available to the process (affinity mask and cgroup CPU
+//   quota) and their NUMA nodes, and plans where worker threads run.
+//
+// このファイルの役割:
+//   プロセスが利用できる CPU（アフィニティマスクと cgroup の CPU クォータ）と
+//   その NUMA ノードを読み取り、ワーカースレッドの配置を計画する。
+//
+// Responsibility in the project:
+//   - Chooses the default number of worker threads
+//   - Maps CPUs to NUMA nodes and orders nodes by distance
+//   - Assigns a CPU and a node to each worker, and pins threads on request
+//   - Does NOT run work or own threads (see ParallelRunner)
+//
+// プロジェクト内での責務:
+//   - ワーカースレッド数の既定値を決定
+//   - CPU を NUMA ノードに対応付け、ノードを距離順に並べる
+//   - 各ワーカーに CPU とノードを割り当て、要求に応じてスレッドを固定する
+//   - 作業の実行やスレッドの所有は担当しない（ParallelRunner を参照）
+//
+// Phase 1 における位置づけ:
+//   Sizing and placement of the ParallelRunner worker pool on multi-socket
+//   machines and in CPU-limited containers. Reads Linux sysfs, procfs, and
+//   cgroup files; on other systems, or when a file is missing, it falls back
+//   to one node and std::thread::hardware_concurrency().
+//   Phase 1では、マルチソケットのマシンや CPU 制限されたコンテナにおける
+//   ParallelRunner のワーカープールの大きさと配置を決める。Linux の sysfs,
+//   procfs, cgroup のファイルを読み取り、他のシステムやファイルがない場合は
+//   1ノードと std::thread::hardware_concurrency() にフォールバックする。
+//
+// ============================================================================
+
+#ifndef REORG_CPU_TOPOLOGY_HPP
+#define REORG_CPU_TOPOLOGY_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+
+namespace CpuTopology {
+
+// ============================================================================
+// WorkerSlot / WorkerPlan
+// ============================================================================
+//
+// Placement of one worker thread, and of the whole pool.
+// 1つのワーカースレッドの配置、およびプール全体の配置。
+//
+// ============================================================================
+struct WorkerSlot {
+    int cpu;   // CPU to pin to (-1 = not pinned) / 固定する CPU（-1 = 固定しない）
+    int node;  // Index of the worker's node in the plan / 計画内のワーカーのノード番号
+};
+
+struct WorkerPlan {
+    std::vector<WorkerSlot> workers;        // One slot per worker / ワーカーごとに1スロット
+    std::vector<int> node_ids;              // System NUMA node ID of each plan node / 計画の各ノードのシステム上の NUMA ノードID
+    std::vector<std::vector<int>> victims;  // Other plan nodes of each node, nearest first / 各ノードから見た他のノード（近い順）
+};
+
+// ----------------------------------------------------------------------------
+// parseCpuList
+// ----------------------------------------------------------------------------
+//
+// Parses a Linux CPU list such as "0-3,8,10-11" into sorted CPU numbers.
+// Malformed entries are skipped.
+// "0-3,8,10-11" のような Linux の CPU リストを、ソート済みの CPU 番号に変換する。
+// 不正な項目は読み飛ばす。
+//
+// ----------------------------------------------------------------------------
+inline std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        try {
+            size_t dash = item.find('-');
+            int first = std::stoi(item.substr(0, dash));
+            int last = (dash == std::string::npos) ? first : std::stoi(item.substr(dash + 1));
+            for (int c = first; c <= last; ++c) {
+                cpus.push_back(c);
+            }
+        } catch (...) {
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+// ----------------------------------------------------------------------------
+// readFirstLine (internal)
+// ----------------------------------------------------------------------------
+inline bool readFirstLine(const std::string& path, std::string& line) {
+    std::ifstream file(path);
+    return file && std::getline(file, line);
+}
+
+// ----------------------------------------------------------------------------
+// allowedCpus
+// ----------------------------------------------------------------------------
+//
+// CPUs in the affinity mask of the process (e.g., restricted by taskset or
+// a container's cpuset). Falls back to 0..hardware_concurrency-1.
+// プロセスのアフィニティマスクに含まれる CPU（taskset やコンテナの cpuset で
+// 制限される）。取得できない場合は 0..hardware_concurrency-1。
+//
+// ----------------------------------------------------------------------------
+inline std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &set)) cpus.push_back(c);
+        }
+    }
+    if (cpus.empty()) {
+        cpus.resize(std::max(1u, std::thread::hardware_concurrency()));
+        std::iota(cpus.begin(), cpus.end(), 0);
+    }
+    return cpus;
+}
+
+// ----------------------------------------------------------------------------
+// cgroupCpuLimit
+// ----------------------------------------------------------------------------
+//
+// CPU quota of the process's cgroup, in CPUs (e.g., 2.5), or 0 if unlimited
+// or unknown. Reads cpu.max (cgroup v2) or cpu.cfs_quota_us and
+// cpu.cfs_period_us (cgroup v1), taking the smallest limit from the
+// process's cgroup up to the root.
+// プロセスの cgroup の CPU クォータ（CPU 数、例: 2.5）。無制限または不明の場合は 0。
+// cpu.max（cgroup v2）または cpu.cfs_quota_us と cpu.cfs_period_us（cgroup v1）を
+// 読み取り、プロセスの cgroup からルートまでで最も小さい制限を採用する。
+//
+// ----------------------------------------------------------------------------
+inline double cgroupCpuLimit() {
+    std::string v2_path, v1_path;
+    {
+        std::ifstream file("/proc/self/cgroup");
+        std::string line;
+        while (std::getline(file, line)) {
+            // Format: hierarchy-ID:controller-list:cgroup-path
+            // 形式: 階層ID:コントローラ一覧:cgroup パス
+            size_t first = line.find(':');
+            size_t second = line.find(':', first + 1);
+            if (first == std::string::npos || second == std::string::npos) continue;
+            std::string controllers = line.substr(first + 1, second - first - 1);
+            std::string path = line.substr(second + 1);
+            if (line.compare(0, first, "0") == 0 && controllers.empty()) {
+                v2_path = path;
+            }
+            std::stringstream ss(controllers);
+            std::string c;
+            while (std::getline(ss, c, ',')) {
+                if (c == "cpu") v1_path = path;
+            }
+        }
+    }
+
+    double limit = 0.0;
+    auto consider = [&](double cpus) {
+        if (cpus > 0.0 && (limit == 0.0 || cpus < limit)) limit = cpus;
+    };
+
+    // Walks from a cgroup path up to the root ("/a/b" -> "/a" -> "")
+    // cgroup パスからルートまで遡る（"/a/b" -> "/a" -> ""）
+    auto for_each_ancestor = [](std::string path, auto body) {
+        if (path == "/") path.clear();
+        for (;;) {
+            body(path);
+            if (path.empty()) break;
+            size_t slash = path.find_last_of('/');
+            path = (slash == std::string::npos || slash == 0) ? std::string() : path.substr(0, slash);
+        }
+    };
+
+    for_each_ancestor(v2_path, [&](const std::string& path) {
+        std::string line;
+        if (!readFirstLine("/sys/fs/cgroup" + path + "/cpu.max", line)) return;
+        std::stringstream ss(line);
+        std::string quota;
+        double period = 0.0;
+        if (ss >> quota >> period && quota != "max" && period > 0.0) {
+            try {
+                consider(std::stod(quota) / period);
+            } catch (...) {
+            }
+        }
+    });
+
+    for (const char* root : {"/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct"}) {
+        for_each_ancestor(v1_path, [&](const std::string& path) {
+            std::string quota_line, period_line;
+            if (!readFirstLine(root + path + "/cpu.cfs_quota_us", quota_line) ||
+                !readFirstLine(root + path + "/cpu.cfs_period_us", period_line)) return;
+            try {
+                double quota = std::stod(quota_line);
+                double period = std::stod(period_line);
+                if (quota > 0.0 && period > 0.0) consider(quota / period);
+            } catch (...) {
+            }
+        });
+    }
+
+    return limit;
+}
+
+// ----------------------------------------------------------------------------
+// defaultThreadCount
+// ----------------------------------------------------------------------------
+//
+// Number of CPUs the process can actually use: the size of the affinity
+// mask, capped by the cgroup CPU quota (rounded down, at least 1).
+// プロセスが実際に使用できる CPU 数: アフィニティマスクの大きさを、cgroup の
+// CPU クォータ（切り捨て、1 以上）で制限したもの。
+//
+// ----------------------------------------------------------------------------
+inline int defaultThreadCount() {
+    int threads = static_cast<int>(allowedCpus().size());
+    double limit = cgroupCpuLimit();
+    if (limit > 0.0) {
+        threads = std::min(threads, std::max(1, static_cast<int>(std::floor(limit))));
+    }
+    return std::max(1, threads);
+}
+
+// ----------------------------------------------------------------------------
+// cpuNodeMap
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   node_ids : Reference to store the system NUMA node IDs found (sorted)
+//
+// 入力:
+//   node_ids : 見つかったシステム上の NUMA ノードID を格納する参照（ソート済み）
+//
+// Output:
+//   For each CPU number, the index into node_ids of its node (-1 if the CPU
+//   is not listed). Empty if /sys/devices/system/node is not available.
+//
+// 出力:
+//   各 CPU 番号について、そのノードの node_ids 内の番号（CPU が記載されていなければ
+//   -1）。/sys/devices/system/node が利用できない場合は空。
+//
+// ----------------------------------------------------------------------------
+inline std::vector<int> cpuNodeMap(std::vector<int>& node_ids) {
+    std::vector<int> node_of_cpu;
+    node_ids.clear();
+
+    std::string online;
+    if (!readFirstLine("/sys/devices/system/node/online", online)) {
+        return node_of_cpu;
+    }
+    for (int node : parseCpuList(online)) {
+        std::string cpulist;
+        if (!readFirstLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", cpulist)) {
+            continue;
+        }
+        std::vector<int> cpus = parseCpuList(cpulist);
+        if (cpus.empty()) continue;  // Memory-only node / メモリのみのノード
+        for (int c : cpus) {
+            if (c >= static_cast<int>(node_of_cpu.size())) node_of_cpu.resize(c + 1, -1);
+            node_of_cpu[c] = static_cast<int>(node_ids.size());
+        }
+        node_ids.push_back(node);
+    }
+    return node_of_cpu;
+}
+
+// ----------------------------------------------------------------------------
+// nodeVictims (internal)
+// ----------------------------------------------------------------------------
+//
+// For each node, the other nodes ordered by the distance reported in
+// /sys/devices/system/node/nodeN/distance (nearest first, ties by index).
+// The distance row has one entry per online node in the order of
+// /sys/devices/system/node/online, so node IDs are looked up by their
+// position in that list, not used as indices.
+// 各ノードについて、/sys/devices/system/node/nodeN/distance の距離順
+// （近い順、同値は番号順）に並べた他のノード。距離の行は
+// /sys/devices/system/node/online の順にオンラインノードごとに1つの値を持つため、
+// ノードID は添字として使わず、その一覧内の位置で引く。
+//
+// ----------------------------------------------------------------------------
+inline std::vector<std::vector<int>> nodeVictims(const std::vector<int>& node_ids) {
+    const int n = static_cast<int>(node_ids.size());
+    std::vector<std::vector<int>> victims(n);
+
+    // Column of each plan node in a distance row (-1 if not online)
+    // 距離の行における各計画ノードの列（オンラインでなければ -1）
+    std::vector<int> column(n, -1);
+    std::string online;
+    if (readFirstLine("/sys/devices/system/node/online", online)) {
+        std::vector<int> online_ids = parseCpuList(online);
+        for (int x = 0; x < n; ++x) {
+            auto it = std::find(online_ids.begin(), online_ids.end(), node_ids[x]);
+            if (it != online_ids.end()) column[x] = static_cast<int>(it - online_ids.begin());
+        }
+    }
+
+    for (int a = 0; a < n; ++a) {
+        std::vector<int> distance;
+        std::string line;
+        if (readFirstLine("/sys/devices/system/node/node" + std::to_string(node_ids[a]) + "/distance", line)) {
+            std::stringstream ss(line);
+            int d;
+            while (ss >> d) distance.push_back(d);
+        }
+        for (int b = 0; b < n; ++b) {
+            if (b != a) victims[a].push_back(b);
+        }
+        std::stable_sort(victims[a].begin(), victims[a].end(), [&](int x, int y) {
+            int dx = column[x] >= 0 && column[x] < static_cast<int>(distance.size()) ? distance[column[x]] : 0;
+            int dy = column[y] >= 0 && column[y] < static_cast<int>(distance.size()) ? distance[column[y]] : 0;
+            return dx < dy;
+        });
+    }
+    return victims;
+}
+
+// ----------------------------------------------------------------------------
+// planWorkers
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   num_threads : Number of worker threads
+//   pin         : Whether to pin each worker to one CPU
+//
+// 入力:
+//   num_threads : ワーカースレッド数
+//   pin         : 各ワーカーを1つの CPU に固定するか
+//
+// Output:
+//   Placement of every worker.
+//
+// 出力:
+//   すべてのワーカーの配置。
+//
+// Guarantee:
+//   - Without pinning, threads may migrate between nodes, so the plan has
+//     a single node and no CPUs
+//   - With pinning, allowed CPUs are taken node by node (compact placement,
+//     so a pool that fits in one socket stays on it); worker t runs on the
+//     t-th CPU (wrapping around if there are more workers than CPUs) and
+//     belongs to that CPU's node; only nodes with workers are in the plan
+//
+// 保証:
+//   - 固定しない場合、スレッドはノード間を移動しうるため、計画は1ノードのみで
+//     CPU を持たない
+//   - 固定する場合、許可された CPU をノードごとに順に使用する（密な配置。1ソケットに
+//     収まるプールはそのソケットに留まる）。ワーカー t は t 番目の CPU（ワーカー数が
+//     CPU 数を超える場合は折り返す）で実行され、その CPU のノードに属する。
+//     計画に含まれるのはワーカーのいるノードのみ
+//
+// ----------------------------------------------------------------------------
+inline WorkerPlan planWorkers(int num_threads, bool pin) {
+    WorkerPlan plan;
+    if (!pin) {
+        plan.workers.assign(num_threads, {-1, 0});
+        plan.node_ids = {0};
+        plan.victims = {{}};
+        return plan;
+    }
+
+    std::vector<int> system_nodes;
+    std::vector<int> node_of_cpu = cpuNodeMap(system_nodes);
+    auto node_of = [&](int cpu) {
+        int node = cpu < static_cast<int>(node_of_cpu.size()) ? node_of_cpu[cpu] : -1;
+        return node < 0 ? 0 : node;
+    };
+
+    std::vector<int> cpus = allowedCpus();
+    std::stable_sort(cpus.begin(), cpus.end(), [&](int a, int b) { return node_of(a) < node_of(b); });
+
+    // Renumber the nodes that receive workers as 0, 1, ...
+    // ワーカーを受け持つノードを 0, 1, ... と番号付けし直す
+    std::vector<int> plan_index(std::max<size_t>(1, system_nodes.size()), -1);
+    for (int t = 0; t < num_threads; ++t) {
+        int cpu = cpus[t % cpus.size()];
+        int node = node_of(cpu);
+        if (plan_index[node] < 0) {
+            plan_index[node] = static_cast<int>(plan.node_ids.size());
+            plan.node_ids.push_back(system_nodes.empty() ? 0 : system_nodes[node]);
+        }
+        plan.workers.push_back({cpu, plan_index[node]});
+    }
+    plan.victims = nodeVictims(plan.node_ids);
+    return plan;
+}
+
+// ----------------------------------------------------------------------------
+// pinCurrentThread
+// ----------------------------------------------------------------------------
+//
+// Restricts the calling thread to one CPU. Returns false on failure.
+// Memory first touched by the thread afterwards is allocated on the CPU's
+// NUMA node (Linux default local allocation).
+// 呼び出したスレッドを1つの CPU に制限する。失敗時は false を返す。
+// その後スレッドが最初に触れたメモリは、その CPU の NUMA ノード上に割り当てられる
+// （Linux の既定のローカル割り当て）。
+//
+// ----------------------------------------------------------------------------
+inline bool pinCurrentThread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+}  // namespace CpuTopology
+
+#endif  // REORG_CPU_TOPOLOGY_HPP
@@ -0,0 +1,165 @@
+// ============================================================================
+// HashUtil.hpp
+// ============================================================================
+//
+// What this file does:
+//   Provides a small non-cryptographic hash (64-bit FNV-1a) for identifying
+//   input files and output contents.
+//
+// このファイルの役割:
+//   入力ファイルや出力内容を識別するための、小さな非暗号学的ハッシュ
+//   （64ビット FNV-1a）を提供する。
+//
+// Responsibility in the project:
+//   - Hashes byte ranges and whole files with FNV-1a (64-bit)
+//   - Formats hash values as fixed-width hexadecimal strings
+//   - Does NOT provide cryptographic guarantees
+//
+// プロジェクト内での責務:
+//   - バイト列およびファイル全体を FNV-1a（64ビット）でハッシュする
+//   - ハッシュ値を固定幅の16進文字列に整形する
+//   - 暗号学的な保証は提供しない
+//
+// Phase 1 における位置づけ:
+//   Used to key persisted run history by polyhedron content.
+//   Phase 1では、多面体の内容をキーとして実行履歴を保存するために使用される。
+//
+// ============================================================================
+
+#ifndef REORG_HASH_UTIL_HPP
+#define REORG_HASH_UTIL_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+namespace HashUtil {
+
+// ----------------------------------------------------------------------------
+// FNV-1a (64-bit) parameters.
+// FNV-1a（64ビット）のパラメータ。
+// ----------------------------------------------------------------------------
+constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+// ----------------------------------------------------------------------------
+// fnv1a64
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   data : Pointer to the bytes to hash
+//   size : Number of bytes
+//   seed : Hash state to continue from (default: FNV offset basis)
+//
+// 入力:
+//   data : ハッシュするバイト列へのポインタ
+//   size : バイト数
+//   seed : 継続するハッシュ状態（既定: FNV オフセット基底）
+//
+// Output:
+//   64-bit FNV-1a hash of the bytes. Passing the result of a previous call as
+//   seed hashes the concatenation of both inputs.
+//
+// 出力:
+//   バイト列の64ビット FNV-1a ハッシュ。前回の呼び出し結果を seed に渡すと、
+//   両入力を連結したものをハッシュした値になる。
+//
+// Guarantee:
+//   - Deterministic across platforms
+//   - No side effects
+//
+// 保証:
+//   - プラットフォームによらず決定的
+//   - 副作用なし
+//
+// ----------------------------------------------------------------------------
+inline std::uint64_t fnv1a64(const void* data, std::size_t size,
+                             std::uint64_t seed = FNV_OFFSET_BASIS) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = seed;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+inline std::uint64_t fnv1a64(const std::string& data,
+                             std::uint64_t seed = FNV_OFFSET_BASIS) {
+    return fnv1a64(data.data(), data.size(), seed);
+}
+
+// ----------------------------------------------------------------------------
+// hashFile
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   path : Path to the file to hash
+//   hash : Reference to store the resulting hash
+//
+// 入力:
+//   path : ハッシュするファイルへのパス
+//   hash : 結果のハッシュを格納する参照
+//
+// Output:
+//   Returns true on success, false if the file cannot be read.
+//
+// 出力:
+//   成功時は true、ファイルを読めない場合は false を返す。
+//
+// Guarantee:
+//   - Hashes the raw bytes of the file (no normalization)
+//   - hash is unchanged on failure
+//
+// 保証:
+//   - ファイルの生のバイト列をハッシュする（正規化しない）
+//   - 失敗時は hash を変更しない
+//
+// ----------------------------------------------------------------------------
+inline bool hashFile(const std::string& path, std::uint64_t& hash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    std::uint64_t h = FNV_OFFSET_BASIS;
+    char buf[1 << 16];
+    while (file.read(buf, sizeof(buf)) || file.gcount() > 0) {
+        h = fnv1a64(buf, static_cast<std::size_t>(file.gcount()), h);
+    }
+
+    hash = h;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// toHex
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   hash : 64-bit hash value
+//
+// 入力:
+//   hash : 64ビットのハッシュ値
+//
+// Output:
+//   16-character lowercase hexadecimal representation (zero-padded).
+//
+// 出力:
+//   16文字の小文字16進表現（ゼロ埋め）。
+//
+// ----------------------------------------------------------------------------
+inline std::string toHex(std::uint64_t hash) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        hex[i] = digits[hash & 0xF];
+        hash >>= 4;
+    }
+    return hex;
+}
+
+}  // namespace HashUtil
+
+#endif  // REORG_HASH_UTIL_HPP
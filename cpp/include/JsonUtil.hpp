@@ -35,6 +35,7 @@
 
 #include "UnfoldedFace.hpp"
 #include "GeometryUtil.hpp"
+#include "SearchOptions.hpp"
 #include <vector>
 #include <ostream>
 #include <iomanip>
@@ -106,6 +107,7 @@ inline double roundTo6Decimals(double value) {
 //   base_edge          : ID of the base edge
 //   symmetric_used     : Whether symmetry pruning was enabled for this unfolding
 //   partial_unfolding  : Vector of UnfoldedFace representing the partial unfolding path
+//   slack              : Endpoint slack to append, or nullptr to omit it
 //
 // 入力:
 //   out                : JSONLレコードを書き込む出力ストリーム
@@ -113,6 +115,7 @@ inline double roundTo6Decimals(double value) {
 //   base_edge          : 基準辺のID
 //   symmetric_used     : この展開図で対称性枝刈りが有効だったか
 //   partial_unfolding  : 部分展開図のパスを表す UnfoldedFace のベクター
+//   slack              : 付加する端点スラック。省略する場合は nullptr
 //
 // Output:
 //   Writes a single JSONL record (one line) to the output stream.
@@ -148,7 +151,8 @@ inline double roundTo6Decimals(double value) {
 //       {"face_id": <int>, "gon": <int>, "edge_id": <int>,
 //        "x": <float>, "y": <float>, "angle_deg": <float>},
 //       ...
-//     ]
+//     ],
+//     "endpoint_slack": {"circle_gap": <float>}   (only when slack != nullptr)
 //   }
 //
 // ----------------------------------------------------------------------------
@@ -157,7 +161,8 @@ inline void writeJsonlRecord(
     int base_face,
     int base_edge,
     bool symmetric_used,
-    const std::vector<UnfoldedFace>& partial_unfolding)
+    const std::vector<UnfoldedFace>& partial_unfolding,
+    const EndpointSlack* slack = nullptr)
 {
     out << "{";
 
@@ -209,6 +214,14 @@ inline void writeJsonlRecord(
     }
     out << "]";
 
+    // endpoint_slack: Optional closeness of the last face to the base face
+    // endpoint_slack: 最終面と基準面の近さ（任意）
+    if (slack != nullptr) {
+        out << ",\"endpoint_slack\":{\"circle_gap\":"
+            << std::fixed << std::setprecision(6) << roundTo6Decimals(slack->circle_gap)
+            << "}";
+    }
+
     out << "}\n";
 }
 
@@ -0,0 +1,287 @@
+// ============================================================================
+// OutputIndex.hpp
+// ============================================================================
+//
+// What this file does:
+//   Builds, writes, and reads the byte-offset index of a raw.jsonl file:
+//   for every root pair, the byte range and record count of its records.
+//
+// このファイルの役割:
+//   raw.jsonl ファイルのバイトオフセット索引を構築・書き込み・読み込みする。
+//   各 root pair について、そのレコードのバイト範囲とレコード数を保持する。
+//
+// Responsibility in the project:
+//   - Scans a JSONL file written in root-pair order into per-root ranges
+//   - Writes and reads the index file (with the size and FNV-1a checksum of
+//     the indexed file, to detect a stale index)
+//   - Does NOT run the search or splice files (see main.cpp)
+//
+// プロジェクト内での責務:
+//   - root pair の順に書き込まれた JSONL ファイルを走査し、root ごとの範囲を求める
+//   - 索引ファイルの書き込みと読み込み（古い索引を検出するため、索引対象の
+//     ファイルのサイズと FNV-1a チェックサムを含む）
+//   - 探索の実行やファイルの結合は担当しない（main.cpp を参照）
+//
+// Phase 1 における位置づけ:
+//   Support for re-running a subset of root pairs (`rotunfold --roots-subset`)
+//   and splicing the new records into an existing raw.jsonl. Because records
+//   are written in root-pair order, each root pair occupies one contiguous
+//   byte range, so the splice only copies ranges.
+//   Phase 1では、root pair の一部の再実行（`rotunfold --roots-subset`）と、
+//   既存の raw.jsonl への新しいレコードの結合を支える。レコードは root pair の
+//   順に書き込まれるため、各 root pair は連続した1つのバイト範囲を占め、
+//   結合は範囲のコピーのみで行える。
+//
+// File format (index JSON):
+//   {
+//     "schema_version": 1,
+//     "record_type": "output_index",
+//     "num_records": int,
+//     "num_bytes": int,
+//     "fnv1a64": string,
+//     "roots": [
+//       {"root_index": int, "base_face": int, "base_edge": int,
+//        "offset": int, "num_bytes": int, "num_records": int},
+//       ...
+//     ]
+//   }
+//
+// ============================================================================
+
+#ifndef REORG_OUTPUT_INDEX_HPP
+#define REORG_OUTPUT_INDEX_HPP
+
+#include "HashUtil.hpp"
+#include "RecordReader.hpp"
+#include "json.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// RootRange
+// ============================================================================
+//
+// The records of one root pair in an indexed file.
+// 索引対象のファイル内の、1つの root pair のレコード。
+//
+// ============================================================================
+struct RootRange {
+    int base_face;          // ID of the base face / 基準面のID
+    int base_edge;          // ID of the base edge / 基準辺のID
+    long long offset;       // Byte offset of the first record / 最初のレコードのバイトオフセット
+    long long num_bytes;    // Length of the range in bytes / 範囲のバイト長
+    long long num_records;  // Number of records / レコード数
+};
+
+// ============================================================================
+// OutputIndex
+// ============================================================================
+//
+// Indexed file: per-root ranges plus the size and checksum of the whole file.
+// 索引対象のファイル: root ごとの範囲と、ファイル全体のサイズ・チェックサム。
+//
+// ============================================================================
+struct OutputIndex {
+    std::vector<RootRange> roots;  // In root-pair order / root pair の順
+    long long num_bytes = 0;       // File size in bytes / ファイルサイズ（バイト）
+    std::uint64_t checksum = HashUtil::FNV_OFFSET_BASIS;  // FNV-1a (64-bit) of the file / ファイルの FNV-1a（64ビット）
+
+    // ------------------------------------------------------------------------
+    // scan
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   data, size : Contents of a JSONL file
+    //   root_pairs : Root pairs in the order the file was written
+    //
+    // 入力:
+    //   data, size : JSONL ファイルの内容
+    //   root_pairs : ファイルが書き込まれた順の root pair
+    //
+    // Output:
+    //   Returns true on success. Returns false (with an error on std::cerr)
+    //   if a line is not a record or the records are not grouped in the
+    //   order of root_pairs.
+    //
+    // 出力:
+    //   成功時は true を返す。レコードでない行がある場合、またはレコードが
+    //   root_pairs の順にまとまっていない場合は false を返す（std::cerr にエラーを出力）。
+    //
+    // Guarantee:
+    //   - Every root pair gets a range; a root pair without records gets an
+    //     empty range at the position where its records would be
+    //   - Ranges include line terminators and tile the whole file
+    //
+    // 保証:
+    //   - すべての root pair に範囲が割り当てられる。レコードのない root pair には、
+    //     そのレコードが入るべき位置に空の範囲が割り当てられる
+    //   - 範囲は改行を含み、ファイル全体を隙間なく覆う
+    //
+    // ------------------------------------------------------------------------
+    bool scan(const char* data, size_t size, const std::vector<std::pair<int, int>>& root_pairs) {
+        roots.clear();
+        for (const auto& [face, edge] : root_pairs) {
+            roots.push_back({face, edge, 0, 0, 0});
+        }
+        num_bytes = static_cast<long long>(size);
+        checksum = HashUtil::fnv1a64(data, size);
+
+        size_t current = 0;
+        long long line_number = 0;
+        ParsedRecord record;
+        size_t pos = 0;
+        while (pos < size) {
+            const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+            size_t end = newline ? static_cast<size_t>(newline - data) + 1 : size;
+            ++line_number;
+
+            size_t len = end - pos;
+            while (len > 0 && (data[pos + len - 1] == '\n' || data[pos + len - 1] == '\r')) --len;
+            if (len > 0) {
+                if (!RecordReader::parseRecord(data + pos, len, record)) {
+                    std::cerr << "Error: Line " << line_number << " is not a partial unfolding record\n";
+                    return false;
+                }
+                while (current < roots.size()
+                       && (roots[current].base_face != record.base_face
+                           || roots[current].base_edge != record.base_edge)) {
+                    ++current;
+                    if (current < roots.size()) roots[current].offset = static_cast<long long>(pos);
+                }
+                if (current == roots.size()) {
+                    std::cerr << "Error: Line " << line_number << " (base_pair " << record.base_face
+                              << ", " << record.base_edge << ") is out of root-pair order\n";
+                    return false;
+                }
+                ++roots[current].num_records;
+            }
+            if (current < roots.size()) {
+                roots[current].num_bytes = static_cast<long long>(end) - roots[current].offset;
+            }
+            pos = end;
+        }
+
+        // Root pairs after the last record start at the end of the file
+        // 最後のレコードより後の root pair はファイル末尾から始まる
+        for (size_t r = current + 1; r < roots.size(); ++r) {
+            roots[r].offset = static_cast<long long>(size);
+        }
+        return true;
+    }
+
+    // ------------------------------------------------------------------------
+    // save
+    // ------------------------------------------------------------------------
+    //
+    // Writes the index to path (via a temporary file and rename).
+    // Returns false on failure (with an error on std::cerr).
+    // 索引を path に書き込む（一時ファイルとリネームを経由）。
+    // 失敗時は false を返す（std::cerr にエラーを出力）。
+    //
+    // ------------------------------------------------------------------------
+    bool save(const std::string& path) const {
+        using json = nlohmann::ordered_json;
+        long long total_records = 0;
+        json entries = json::array();
+        for (size_t r = 0; r < roots.size(); ++r) {
+            const RootRange& range = roots[r];
+            total_records += range.num_records;
+            entries.push_back({
+                {"root_index", r},
+                {"base_face", range.base_face},
+                {"base_edge", range.base_edge},
+                {"offset", range.offset},
+                {"num_bytes", range.num_bytes},
+                {"num_records", range.num_records}
+            });
+        }
+
+        json index;
+        index["schema_version"] = 1;
+        index["record_type"] = "output_index";
+        index["num_records"] = total_records;
+        index["num_bytes"] = num_bytes;
+        index["fnv1a64"] = HashUtil::toHex(checksum);
+        index["roots"] = entries;
+
+        const std::string tmp_path = path + ".tmp";
+        {
+            std::ofstream out(tmp_path);
+            if (!out) {
+                std::cerr << "Error: Cannot write index: " << tmp_path << "\n";
+                return false;
+            }
+            out << index.dump(1) << "\n";
+            if (!out) {
+                std::cerr << "Error: Cannot write index: " << tmp_path << "\n";
+                return false;
+            }
+        }
+        if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+            std::cerr << "Error: Cannot replace index: " << path << "\n";
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // ------------------------------------------------------------------------
+    // load
+    // ------------------------------------------------------------------------
+    //
+    // Reads the index from path. Returns false on failure, with the reason
+    // stored in *error if error is given, or as an error on std::cerr
+    // otherwise (a caller that can recover reports it as it sees fit).
+    // path から索引を読み込む。失敗時は false を返す。error が与えられれば理由を
+    // *error に格納し、そうでなければ std::cerr にエラーを出力する（回復できる
+    // 呼び出し側は、自身に合った形で報告する）。
+    //
+    // ------------------------------------------------------------------------
+    bool load(const std::string& path, std::string* error = nullptr) {
+        using json = nlohmann::json;
+        auto fail = [&](const std::string& message) {
+            if (error) {
+                *error = message;
+            } else {
+                std::cerr << "Error: " << message << "\n";
+            }
+            return false;
+        };
+
+        std::ifstream file(path);
+        if (!file) {
+            return fail("Cannot open index: " + path);
+        }
+
+        try {
+            json j;
+            file >> j;
+            if (!j.contains("record_type") || j["record_type"] != "output_index") {
+                return fail("Not an output index: " + path);
+            }
+            roots.clear();
+            for (const auto& e : j.at("roots")) {
+                roots.push_back({
+                    e.at("base_face").get<int>(),
+                    e.at("base_edge").get<int>(),
+                    e.at("offset").get<long long>(),
+                    e.at("num_bytes").get<long long>(),
+                    e.at("num_records").get<long long>()
+                });
+            }
+            num_bytes = j.at("num_bytes").get<long long>();
+            checksum = std::stoull(j.at("fnv1a64").get<std::string>(), nullptr, 16);
+        } catch (const std::exception& e) {
+            return fail("Invalid index " + path + ": " + e.what());
+        }
+        return true;
+    }
+};
+
+#endif  // REORG_OUTPUT_INDEX_HPP
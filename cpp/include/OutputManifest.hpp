@@ -0,0 +1,414 @@
+// ============================================================================
+// OutputManifest.hpp
+// ============================================================================
+//
+// What this file does:
+//   Supports the per-task output layout: each search task writes its own
+//   JSONL file, and a manifest lists the files in canonical order with their
+//   record counts, byte sizes, and checksums.
+//
+// このファイルの役割:
+//   タスクごとの出力レイアウトを支える。各探索タスクは自身の JSONL ファイルに
+//   書き込み、マニフェストはそれらのファイルを正規の順序で、レコード数・
+//   バイト数・チェックサムとともに列挙する。
+//
+// Responsibility in the project:
+//   - Names per-task output files, and removes those of a previous run
+//   - Writes a file while counting its records, bytes, and FNV-1a checksum
+//   - Writes and reads manifest.json
+//   - Does NOT run the search or schedule tasks
+//
+// プロジェクト内での責務:
+//   - タスクごとの出力ファイルに名前を付け、以前の実行のものを削除する
+//   - レコード数・バイト数・FNV-1a チェックサムを数えながらファイルに書き込む
+//   - manifest.json の書き込みと読み込み
+//   - 探索の実行やタスクのスケジューリングは担当しない
+//
+// Phase 1 における位置づけ:
+//   Output layer of `rotunfold --out-dir`. Workers write concurrently with no
+//   global ordering; concatenating the files in manifest order reproduces
+//   raw.jsonl byte for byte (see `rotunfold-stats concat`).
+//   Phase 1では、`rotunfold --out-dir` の出力層。ワーカーは全体の順序付けなしに
+//   並行して書き込み、マニフェストの順にファイルを連結すると raw.jsonl を
+//   バイト単位で再現する（`rotunfold-stats concat` を参照）。
+//
+// File format (manifest.json):
+//   {
+//     "schema_version": 1,
+//     "record_type": "output_manifest",
+//     "symmetric_used": bool,
+//     "num_records": int,
+//     "num_bytes": int,
+//     "files": [
+//       {"path": string, "root_index": int, "base_face": int, "base_edge": int,
+//        "first_branch": int, "num_records": int, "num_bytes": int,
+//        "fnv1a64": string},
+//       ...
+//     ]
+//   }
+//
+// ============================================================================
+
+#ifndef REORG_OUTPUT_MANIFEST_HPP
+#define REORG_OUTPUT_MANIFEST_HPP
+
+#include "HashUtil.hpp"
+#include "json.hpp"
+#include <cstdint>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// TaskFile
+// ============================================================================
+//
+// One entry of the manifest: the output file of a single task.
+// マニフェストの1エントリ: 1つのタスクの出力ファイル。
+//
+// ============================================================================
+struct TaskFile {
+    std::string path;         // File name, relative to the output directory / 出力ディレクトリからの相対ファイル名
+    int root_index;           // Index into the root pair list / root pair リスト内の番号
+    int base_face;            // ID of the base face / 基準面のID
+    int base_edge;            // ID of the base edge / 基準辺のID
+    int first_branch;         // Branch from the second face (-1 = whole root) / 2番目の面からの枝（-1 = root 全体）
+    long long num_records;    // Number of JSONL records / JSONL レコード数
+    long long num_bytes;      // File size in bytes / ファイルサイズ（バイト）
+    std::uint64_t checksum;   // FNV-1a (64-bit) of the file contents / ファイル内容の FNV-1a（64ビット）
+};
+
+// ============================================================================
+// ChecksumFileBuf
+// ============================================================================
+//
+// Output stream buffer that writes to a file and keeps a running byte count,
+// line count, and FNV-1a checksum of everything written.
+// ファイルに書き込みながら、書き込んだ内容のバイト数・行数・FNV-1a チェックサムを
+// 逐次計算する出力ストリームバッファ。
+//
+// ============================================================================
+class ChecksumFileBuf : public std::streambuf {
+public:
+    ChecksumFileBuf() {
+        setp(buffer, buffer + sizeof(buffer));
+    }
+    ChecksumFileBuf(const ChecksumFileBuf&) = delete;
+    ChecksumFileBuf& operator=(const ChecksumFileBuf&) = delete;
+
+    ~ChecksumFileBuf() override {
+        close();
+    }
+
+    // Opens path for writing (truncating it). Returns false on failure.
+    // path を書き込み用に開く（切り詰める）。失敗時は false を返す。
+    bool open(const std::string& path) {
+        file = std::fopen(path.c_str(), "wb");
+        return file != nullptr;
+    }
+
+    // Flushes and closes the file. Returns false if any write failed.
+    // フラッシュしてファイルを閉じる。書き込みに失敗していれば false を返す。
+    bool close() {
+        if (file == nullptr) return ok;
+        flushBuffer();
+        if (std::fclose(file) != 0) ok = false;
+        file = nullptr;
+        return ok;
+    }
+
+    long long bytes() const { return num_bytes + (pptr() - pbase()); }
+    long long lines() const { return num_lines; }
+    std::uint64_t checksum() const { return hash; }
+
+protected:
+    int overflow(int c) override {
+        if (!flushBuffer()) return traits_type::eof();
+        if (c != traits_type::eof()) {
+            *pptr() = static_cast<char>(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        return flushBuffer() ? 0 : -1;
+    }
+
+private:
+    std::FILE* file = nullptr;
+    bool ok = true;
+    char buffer[1 << 16];
+    long long num_bytes = 0;
+    long long num_lines = 0;
+    std::uint64_t hash = HashUtil::FNV_OFFSET_BASIS;
+
+    bool flushBuffer() {
+        std::size_t n = static_cast<std::size_t>(pptr() - pbase());
+        if (n > 0) {
+            hash = HashUtil::fnv1a64(pbase(), n, hash);
+            for (const char* p = pbase(); p != pptr(); ++p) {
+                if (*p == '\n') ++num_lines;
+            }
+            num_bytes += static_cast<long long>(n);
+            if (file == nullptr || std::fwrite(pbase(), 1, n, file) != n) ok = false;
+            setp(buffer, buffer + sizeof(buffer));
+        }
+        return ok;
+    }
+};
+
+namespace OutputManifest {
+
+using json = nlohmann::ordered_json;
+
+// ----------------------------------------------------------------------------
+// Name of the manifest file in the output directory.
+// 出力ディレクトリ内のマニフェストファイル名。
+// ----------------------------------------------------------------------------
+const char* const MANIFEST_NAME = "manifest.json";
+
+// ----------------------------------------------------------------------------
+// taskFileName
+// ----------------------------------------------------------------------------
+//
+// Returns the file name of a task's output, e.g. "root_00012_b2.jsonl"
+// (root index zero-padded to 5 digits; "_b<branch>" only for split roots).
+// Names sort in canonical order.
+//
+// タスク出力のファイル名を返す。例: "root_00012_b2.jsonl"
+// （root の番号は5桁にゼロ埋め。"_b<枝>" は分割された root のみ）。
+// 名前は正規の順序でソートされる。
+//
+// ----------------------------------------------------------------------------
+inline std::string taskFileName(int root_index, int first_branch) {
+    char name[64];
+    if (first_branch < 0) {
+        std::snprintf(name, sizeof(name), "root_%05d.jsonl", root_index);
+    } else {
+        std::snprintf(name, sizeof(name), "root_%05d_b%d.jsonl", root_index, first_branch);
+    }
+    return name;
+}
+
+// ----------------------------------------------------------------------------
+// isTaskFileName
+// ----------------------------------------------------------------------------
+//
+// Returns true if name has the form produced by taskFileName
+// ("root_<digits>.jsonl" or "root_<digits>_b<digits>.jsonl").
+// name が taskFileName の生成する形式（"root_<数字>.jsonl" または
+// "root_<数字>_b<数字>.jsonl"）であれば true を返す。
+//
+// ----------------------------------------------------------------------------
+inline bool isTaskFileName(const std::string& name) {
+    const std::string prefix = "root_";
+    const std::string suffix = ".jsonl";
+    if (name.size() <= prefix.size() + suffix.size() ||
+        name.compare(0, prefix.size(), prefix) != 0 ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return false;
+    }
+    const std::string stem = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+    auto digits = [&](size_t begin, size_t end) {
+        if (begin >= end) return false;
+        for (size_t i = begin; i < end; ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(stem[i]))) return false;
+        }
+        return true;
+    };
+    size_t branch = stem.find("_b");
+    if (branch == std::string::npos) return digits(0, stem.size());
+    return digits(0, branch) && digits(branch + 2, stem.size());
+}
+
+// ----------------------------------------------------------------------------
+// removeTaskFiles
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   dir : Output directory
+//
+// 入力:
+//   dir : 出力ディレクトリ
+//
+// Output:
+//   Returns true on success, false on failure (with an error on std::cerr).
+//
+// 出力:
+//   成功時は true、失敗時は false を返す（std::cerr にエラーを出力）。
+//
+// Guarantee:
+//   - Removes manifest.json and every task file in dir, so a run into an
+//     existing directory leaves no file of a previous run behind, even one
+//     that was interrupted before writing its manifest
+//   - Other files in dir are kept
+//
+// 保証:
+//   - dir 内の manifest.json とすべてのタスクファイルを削除するため、既存の
+//     ディレクトリへの実行は、マニフェストを書く前に中断した実行のものも含め、
+//     以前の実行のファイルを残さない
+//   - dir 内のその他のファイルは保持される
+//
+// ----------------------------------------------------------------------------
+inline bool removeTaskFiles(const std::string& dir) {
+    std::error_code ec;
+    std::filesystem::remove(std::filesystem::path(dir) / MANIFEST_NAME, ec);
+    if (ec) {
+        std::cerr << "Error: Cannot remove " << MANIFEST_NAME << " in " << dir << "\n";
+        return false;
+    }
+    std::filesystem::directory_iterator it(dir, ec), end;
+    for (; !ec && it != end; it.increment(ec)) {
+        const std::string name = it->path().filename().string();
+        if (isTaskFileName(name) && !std::filesystem::remove(it->path(), ec)) {
+            break;
+        }
+    }
+    if (ec) {
+        std::cerr << "Error: Cannot remove previous task files in " << dir << "\n";
+        return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// writeManifest
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   manifest_path  : Path of the manifest file
+//   symmetric_used : Whether symmetry pruning was enabled
+//   files          : Task files in canonical order
+//
+// 入力:
+//   manifest_path  : マニフェストファイルのパス
+//   symmetric_used : 対称性枝刈りが有効だったか
+//   files          : 正規の順序のタスクファイル
+//
+// Output:
+//   Returns true on success, false on failure (with an error on std::cerr).
+//
+// 出力:
+//   成功時は true、失敗時は false を返す（std::cerr にエラーを出力）。
+//
+// Guarantee:
+//   - Writes to a temporary file and renames it, so the manifest exists only
+//     once every task file is complete
+//
+// 保証:
+//   - 一時ファイルに書き込んでからリネームするため、マニフェストはすべての
+//     タスクファイルが完成した後にのみ存在する
+//
+// ----------------------------------------------------------------------------
+inline bool writeManifest(const std::string& manifest_path,
+                          bool symmetric_used,
+                          const std::vector<TaskFile>& files) {
+    long long total_records = 0;
+    long long total_bytes = 0;
+    json entries = json::array();
+    for (const auto& f : files) {
+        total_records += f.num_records;
+        total_bytes += f.num_bytes;
+        entries.push_back({
+            {"path", f.path},
+            {"root_index", f.root_index},
+            {"base_face", f.base_face},
+            {"base_edge", f.base_edge},
+            {"first_branch", f.first_branch},
+            {"num_records", f.num_records},
+            {"num_bytes", f.num_bytes},
+            {"fnv1a64", HashUtil::toHex(f.checksum)}
+        });
+    }
+
+    json manifest;
+    manifest["schema_version"] = 1;
+    manifest["record_type"] = "output_manifest";
+    manifest["symmetric_used"] = symmetric_used;
+    manifest["num_records"] = total_records;
+    manifest["num_bytes"] = total_bytes;
+    manifest["files"] = entries;
+
+    const std::string tmp_path = manifest_path + ".tmp";
+    {
+        std::ofstream out(tmp_path);
+        if (!out) {
+            std::cerr << "Error: Cannot write manifest: " << tmp_path << "\n";
+            return false;
+        }
+        out << manifest.dump(1) << "\n";
+        if (!out) {
+            std::cerr << "Error: Cannot write manifest: " << tmp_path << "\n";
+            return false;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), manifest_path.c_str()) != 0) {
+        std::cerr << "Error: Cannot replace manifest: " << manifest_path << "\n";
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// loadManifest
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   manifest_path : Path of the manifest file
+//   files         : Reference to store the task files in manifest order
+//
+// 入力:
+//   manifest_path : マニフェストファイルのパス
+//   files         : タスクファイルをマニフェストの順に格納する参照
+//
+// Output:
+//   Returns true on success, false on failure (with an error on std::cerr).
+//
+// 出力:
+//   成功時は true、失敗時は false を返す（std::cerr にエラーを出力）。
+//
+// ----------------------------------------------------------------------------
+inline bool loadManifest(const std::string& manifest_path, std::vector<TaskFile>& files) {
+    std::ifstream file(manifest_path);
+    if (!file) {
+        std::cerr << "Error: Cannot open manifest: " << manifest_path << "\n";
+        return false;
+    }
+
+    try {
+        json j;
+        file >> j;
+        if (!j.contains("record_type") || j["record_type"] != "output_manifest") {
+            std::cerr << "Error: Not an output manifest: " << manifest_path << "\n";
+            return false;
+        }
+        files.clear();
+        for (const auto& e : j.at("files")) {
+            TaskFile f;
+            f.path = e.at("path").get<std::string>();
+            f.root_index = e.at("root_index").get<int>();
+            f.base_face = e.at("base_face").get<int>();
+            f.base_edge = e.at("base_edge").get<int>();
+            f.first_branch = e.at("first_branch").get<int>();
+            f.num_records = e.at("num_records").get<long long>();
+            f.num_bytes = e.at("num_bytes").get<long long>();
+            f.checksum = std::stoull(e.at("fnv1a64").get<std::string>(), nullptr, 16);
+            files.push_back(f);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Invalid manifest " << manifest_path << ": " << e.what() << "\n";
+        return false;
+    }
+    return true;
+}
+
+}  // namespace OutputManifest
+
+#endif  // REORG_OUTPUT_MANIFEST_HPP
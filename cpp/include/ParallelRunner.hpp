@@ -0,0 +1,761 @@
+// ============================================================================
+// ParallelRunner.hpp
+// ============================================================================
+//
+// What this file does:
+//   Runs the rotational unfolding search for many root pairs on a pool of
+//   worker threads, while writing the output in the same order as a serial run.
+//
+// このファイルの役割:
+//   多数の root pair に対する回転展開探索をワーカースレッドのプールで実行し、
+//   出力は逐次実行と同じ順序で書き込む。
+//
+// Responsibility in the project:
+//   - Probes the cost of root pairs with a node-limited search
+//   - Splits expensive root pairs into per-branch tasks
+//   - Schedules tasks longest-first across worker threads
+//   - Places workers on CPUs and NUMA nodes (see CpuTopology, NodeWorkQueue)
+//   - Writes task outputs in canonical (root pair, branch) order
+//   - Collects the K tightest candidates in the top-K mode
+//   - Writes one file per task concurrently in the per-task output layout
+//   - Measures node counts and wall times per task
+//   - Does NOT contain search logic or persist costs
+//
+// プロジェクト内での責務:
+//   - ノード数上限付きの探索で root pair のコストをプローブ
+//   - コストの大きい root pair を枝ごとのタスクに分割
+//   - タスクを長いものから順にワーカースレッドへ割り当てる
+//   - ワーカーを CPU と NUMA ノードに配置（CpuTopology, NodeWorkQueue を参照）
+//   - タスクの出力を正規の順序（root pair、枝）で書き込む
+//   - top-K モードでは最も厳しい K 個の候補を収集
+//   - タスクごとの出力レイアウトでは、タスクごとに1ファイルを並行して書き込む
+//   - タスクごとのノード数と経過時間を計測
+//   - 探索ロジックやコストの保存は担当しない
+//
+// Phase 1 における位置づけ:
+//   Execution layer between the CLI and RotationalUnfolding.
+//   The output is byte-identical to a serial run for any number of threads.
+//   Phase 1では、CLI と RotationalUnfolding の間の実行層。
+//   スレッド数によらず、出力は逐次実行とバイト単位で一致する。
+//
+// ============================================================================
+
+#ifndef REORG_PARALLEL_RUNNER_HPP
+#define REORG_PARALLEL_RUNNER_HPP
+
+#include "RotationalUnfolding.hpp"
+#include "Polyhedron.hpp"
+#include "SearchOptions.hpp"
+#include "TopK.hpp"
+#include "OutputManifest.hpp"
+#include "ReorderBuffer.hpp"
+#include "CpuTopology.hpp"
+#include "WorkQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// SearchTask
+// ============================================================================
+//
+// A unit of work: the search from one root pair, or one branch of it.
+// 作業の単位: 1つの root pair からの探索、またはその1つの枝。
+//
+// ============================================================================
+struct SearchTask {
+    int root_index;         // Index into the root pair list / root pair リスト内の番号
+    int base_face;          // ID of the base face / 基準面のID
+    int base_edge;          // ID of the base edge / 基準辺のID
+    int first_branch;       // Branch from the second face (-1 = whole root) / 2番目の面からの枝（-1 = root 全体）
+    double predicted_cost;  // Predicted cost (arbitrary unit) / 予測コスト（単位は任意）
+};
+
+// ============================================================================
+// TaskStats
+// ============================================================================
+//
+// Measured cost of a single task.
+// 1つのタスクの計測コスト。
+//
+// ============================================================================
+struct TaskStats {
+    long long nodes = 0;    // Search nodes visited / 訪問した探索ノード数
+    double seconds = 0.0;   // Wall time / 経過時間
+};
+
+// ============================================================================
+// ParallelRunner
+// ============================================================================
+//
+// Executes search tasks on worker threads with deterministic output order.
+// 出力順序を決定的に保ちながら、探索タスクをワーカースレッドで実行する。
+//
+// Responsibility:
+//   - Provides cost probing, task planning, scheduling, and execution
+//   - Buffers out-of-order task outputs until all preceding tasks are written,
+//     within a memory cap (see ReorderBuffer)
+//
+// 責務:
+//   - コストのプローブ、タスク計画、スケジューリング、実行を提供
+//   - 先行するすべてのタスクが書き込まれるまで、順序外のタスク出力をメモリ上限内で
+//     保持（ReorderBuffer を参照）
+//
+// Does NOT handle:
+//   - Loading or saving the cost model
+//   - Choosing the number of threads
+//
+// 責務外:
+//   - コストモデルの読み込み・保存
+//   - スレッド数の決定
+//
+// ============================================================================
+class ParallelRunner {
+public:
+    // ------------------------------------------------------------------------
+    // Constructor
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   poly        : Reference to the polyhedron structure (immutable, shared)
+    //   symmetric   : Whether symmetry pruning is enabled
+    //   options     : Search options passed to every RotationalUnfolding
+    //   num_threads : Number of worker threads (>= 1)
+    //   pin_threads : Whether to pin each worker to one CPU
+    //
+    // 入力:
+    //   poly        : 多面体構造への参照（不変、共有）
+    //   symmetric   : 対称性枝刈りが有効か
+    //   options     : すべての RotationalUnfolding に渡す探索オプション
+    //   num_threads : ワーカースレッド数（1 以上）
+    //   pin_threads : 各ワーカーを1つの CPU に固定するか
+    //
+    // Guarantee:
+    //   - Pinned workers are placed compactly, node by node, and take tasks
+    //     from their own node's queue before stealing from the nearest other
+    //     node (see CpuTopology::planWorkers); each worker allocates its
+    //     search state after pinning, so the state lives on its node
+    //   - Placement never changes the output
+    //
+    // 保証:
+    //   - 固定されたワーカーはノードごとに密に配置され、自ノードのキューのタスクを
+    //     取り、なくなると最も近い他ノードから奪う（CpuTopology::planWorkers を参照）。
+    //     各ワーカーは固定後に探索状態を確保するため、状態は自ノード上に置かれる
+    //   - 配置が出力を変えることはない
+    //
+    // ------------------------------------------------------------------------
+    ParallelRunner(const Polyhedron& poly,
+                   bool symmetric,
+                   const SearchOptions& options,
+                   int num_threads,
+                   bool pin_threads = false)
+        : polyhedron(poly),
+        symmetric(symmetric),
+        options(options),
+        num_threads(std::max(1, num_threads)),
+        placement(CpuTopology::planWorkers(this->num_threads, pin_threads)) {}
+
+    // ------------------------------------------------------------------------
+    // probeRoots
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   root_pairs : List of (base_face, base_edge) pairs
+    //   node_limit : Maximum number of nodes visited per root pair
+    //
+    // 入力:
+    //   root_pairs : (基準面, 基準辺) ペアのリスト
+    //   node_limit : root pair ごとに訪問するノード数の上限
+    //
+    // Output:
+    //   Number of nodes visited for each root pair (capped at node_limit + 1).
+    //   A root pair whose search completed within the limit reports its exact
+    //   node count.
+    //
+    // 出力:
+    //   各 root pair で訪問したノード数（node_limit + 1 で頭打ち）。
+    //   上限内で探索が完了した root pair は正確なノード数を返す。
+    //
+    // Guarantee:
+    //   - Output of the probes is discarded
+    //   - Runs on the worker threads
+    //
+    // 保証:
+    //   - プローブの出力は破棄される
+    //   - ワーカースレッド上で実行される
+    //
+    // ------------------------------------------------------------------------
+    std::vector<long long> probeRoots(const std::vector<std::pair<int, int>>& root_pairs,
+                                      long long node_limit) const {
+        std::vector<long long> nodes(root_pairs.size(), 0);
+
+        SearchOptions probe_options = options;
+        probe_options.node_limit = node_limit;
+
+        parallelFor(root_pairs.size(), [&](size_t i, int) {
+            std::ostringstream discard;
+            discard.setstate(std::ios::badbit);
+            RotationalUnfolding rot_ufd(polyhedron, root_pairs[i].first, root_pairs[i].second,
+                                        symmetric, symmetric, probe_options);
+            rot_ufd.runRotationalUnfolding(discard);
+            nodes[i] = rot_ufd.nodeCount();
+        });
+
+        return nodes;
+    }
+
+    // ------------------------------------------------------------------------
+    // planTasks
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   root_pairs : List of (base_face, base_edge) pairs
+    //   root_costs : Predicted cost of each root pair (any non-negative unit)
+    //
+    // 入力:
+    //   root_pairs : (基準面, 基準辺) ペアのリスト
+    //   root_costs : 各 root pair の予測コスト（非負であれば単位は任意）
+    //
+    // Output:
+    //   Tasks in canonical order (by root pair, then by branch).
+    //
+    // 出力:
+    //   正規の順序（root pair 順、次に枝順）のタスク列。
+    //
+    // Guarantee:
+    //   - With more than one thread, a root pair whose cost exceeds half of
+    //     a fair per-thread share is split into one task per first branch
+    //   - The predicted cost of a split root is divided evenly among its tasks
+    //   - Concatenating task outputs in the returned order reproduces the
+    //     serial output
+    //
+    // 保証:
+    //   - 複数スレッドの場合、コストがスレッドあたりの公平な取り分の半分を
+    //     超える root pair は、最初の枝ごとのタスクに分割される
+    //   - 分割された root の予測コストはタスク間で均等に分配される
+    //   - 返された順にタスク出力を連結すると逐次実行の出力を再現する
+    //
+    // ------------------------------------------------------------------------
+    std::vector<SearchTask> planTasks(const std::vector<std::pair<int, int>>& root_pairs,
+                                      const std::vector<double>& root_costs) const {
+        double total = std::accumulate(root_costs.begin(), root_costs.end(), 0.0);
+        double split_threshold = total / (2.0 * num_threads);
+
+        std::vector<SearchTask> tasks;
+        for (int r = 0; r < static_cast<int>(root_pairs.size()); ++r) {
+            const auto& [face, edge] = root_pairs[r];
+            double cost = root_costs[r];
+
+            int branches = 1;
+            if (num_threads > 1 && cost > split_threshold) {
+                RotationalUnfolding rot_ufd(polyhedron, face, edge, symmetric, symmetric, options);
+                branches = std::max(1, rot_ufd.numFirstBranches());
+            }
+
+            if (branches == 1) {
+                tasks.push_back({r, face, edge, -1, cost});
+            } else {
+                for (int b = 0; b < branches; ++b) {
+                    tasks.push_back({r, face, edge, b, cost / branches});
+                }
+            }
+        }
+        return tasks;
+    }
+
+    // ------------------------------------------------------------------------
+    // scheduleTasks
+    // ------------------------------------------------------------------------
+    //
+    // Returns the indices of tasks in execution order: longest predicted cost
+    // first, ties broken by canonical order. With one thread, the canonical
+    // order is kept so that no output needs to be buffered.
+    //
+    // タスクの番号を実行順で返す: 予測コストの大きい順、同値の場合は正規の順序。
+    // 1スレッドの場合は、出力を保持する必要がないよう正規の順序を保つ。
+    //
+    // ------------------------------------------------------------------------
+    std::vector<int> scheduleTasks(const std::vector<SearchTask>& tasks) const {
+        std::vector<int> order(tasks.size());
+        std::iota(order.begin(), order.end(), 0);
+        if (num_threads > 1) {
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+                return tasks[a].predicted_cost > tasks[b].predicted_cost;
+            });
+        }
+        return order;
+    }
+
+    // ------------------------------------------------------------------------
+    // run
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   tasks        : Tasks in canonical order (see planTasks)
+    //   schedule     : Execution order (see scheduleTasks)
+    //   num_roots    : Number of root pairs (for progress reporting)
+    //   jsonl_output : Output stream for JSONL records
+    //   memory_cap   : Maximum bytes of out-of-order output held in memory
+    //   spill_dir    : Directory for the temporary file above the memory cap
+    //
+    // 入力:
+    //   tasks        : 正規の順序のタスク列（planTasks を参照）
+    //   schedule     : 実行順序（scheduleTasks を参照）
+    //   num_roots    : root pair の数（進捗報告用）
+    //   jsonl_output : JSONLレコード用の出力ストリーム
+    //   memory_cap   : メモリに保持する順序外の出力の最大バイト数
+    //   spill_dir    : メモリ上限を超えた分の一時ファイル用ディレクトリ
+    //
+    // Output:
+    //   Measured statistics for each task (indexed like tasks), or an empty
+    //   vector if the output could not be written.
+    //   Writes all records to jsonl_output.
+    //
+    // 出力:
+    //   各タスクの計測統計（tasks と同じ添字）。出力を書き込めなかった場合は
+    //   空のベクター。
+    //   すべてのレコードを jsonl_output に書き込む。
+    //
+    // Guarantee:
+    //   - Output is written in canonical task order, identical to a serial run
+    //   - The task next in canonical order is streamed while it runs; other
+    //     tasks' output is held in memory up to memory_cap and spilled to
+    //     a temporary file beyond it, so peak memory does not grow with the
+    //     size of the output
+    //   - Output is flushed after each root pair
+    //   - Progress is reported to stderr as root pairs are written
+    //   - Once jsonl_output fails, sets SearchOptions::stop (if given), so the
+    //     remaining tasks end early
+    //
+    // 保証:
+    //   - 出力は正規のタスク順で書き込まれ、逐次実行と一致する
+    //   - 正規の順序で次のタスクは実行中に逐次書き出される。その他のタスクの出力は
+    //     memory_cap までメモリに保持し、それを超える分は一時ファイルに退避するため、
+    //     ピークメモリは出力サイズに応じて増加しない
+    //   - 各 root pair の後に出力をフラッシュする
+    //   - root pair が書き込まれるたびに stderr に進捗を報告する
+    //   - jsonl_output が失敗すると SearchOptions::stop（指定時）を設定し、
+    //     残りのタスクを早期に終了させる
+    //
+    // ------------------------------------------------------------------------
+    std::vector<TaskStats> run(const std::vector<SearchTask>& tasks,
+                               const std::vector<int>& schedule,
+                               int num_roots,
+                               std::ostream& jsonl_output,
+                               size_t memory_cap,
+                               const std::string& spill_dir) const {
+        std::vector<TaskStats> stats(tasks.size());
+        int roots_written = 0;
+
+        // Serial path: tasks already in canonical order are written directly
+        // 逐次パス: 正規の順序のタスクは直接書き込む
+        if (num_threads == 1) {
+            for (int idx : schedule) {
+                if (stopped()) break;
+                stats[idx] = runTask(tasks[idx], jsonl_output);
+                finishTask(tasks, idx, num_roots, roots_written, jsonl_output);
+                stopIfFailed(jsonl_output);
+            }
+            if (!jsonl_output.good()) {
+                return {};
+            }
+            return stats;
+        }
+
+        // Parallel path: workers hand each task's output over in chunks; this
+        // thread writes the chunks in canonical task order
+        // 並列パス: ワーカーは各タスクの出力をチャンク単位で受け渡し、
+        // このスレッドがチャンクを正規のタスク順で書き込む
+        ReorderBuffer reorder(tasks.size(), memory_cap, spill_dir);
+        bool failed = false;
+
+        std::thread writer([&]() {
+            for (int idx = 0; idx < static_cast<int>(tasks.size()); ++idx) {
+                if (!reorder.writeTask(idx, jsonl_output)) {
+                    failed = true;
+                }
+                finishTask(tasks, idx, num_roots, roots_written, jsonl_output);
+                stopIfFailed(jsonl_output);
+            }
+        });
+
+        parallelFor(schedule.size(), [&](size_t k, int) {
+            int idx = schedule[k];
+            ReorderStreamBuf buffer(reorder, idx);
+            std::ostream out(&buffer);
+            stats[idx] = runTask(tasks[idx], out);
+            buffer.finish();
+        });
+
+        // Tasks skipped after a stop have no output; release the writer
+        // 打ち切り後に飛ばしたタスクには出力がないため、書き込みスレッドを解放する
+        if (stopped()) {
+            for (size_t idx = 0; idx < tasks.size(); ++idx) {
+                reorder.finish(static_cast<int>(idx));
+            }
+        }
+        writer.join();
+
+        if (reorder.spilledBytes() > 0) {
+            std::cerr << "Info: Reorder buffer spilled " << reorder.spilledBytes()
+                      << " bytes to a temporary file (peak in memory: "
+                      << reorder.peakMemory() << " bytes)\n";
+        }
+        if (failed || !jsonl_output.good()) {
+            return {};
+        }
+        return stats;
+    }
+
+    // ------------------------------------------------------------------------
+    // runToFiles
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   tasks      : Tasks in canonical order (see planTasks)
+    //   schedule   : Execution order (see scheduleTasks)
+    //   output_dir : Existing directory to write the task files into
+    //   files      : Reference to store the task files (indexed like tasks)
+    //
+    // 入力:
+    //   tasks      : 正規の順序のタスク列（planTasks を参照）
+    //   schedule   : 実行順序（scheduleTasks を参照）
+    //   output_dir : タスクファイルを書き込む既存のディレクトリ
+    //   files      : タスクファイルを格納する参照（tasks と同じ添字）
+    //
+    // Output:
+    //   Measured statistics for each task (indexed like tasks), or an empty
+    //   vector if a task file could not be written.
+    //
+    // 出力:
+    //   各タスクの計測統計（tasks と同じ添字）。タスクファイルを書き込めなかった
+    //   場合は空のベクター。
+    //
+    // Guarantee:
+    //   - Every task writes its records directly to its own file
+    //     (OutputManifest::taskFileName); no output is buffered in memory and
+    //     no task waits for another
+    //   - Concatenating the files in canonical order reproduces the output of run
+    //   - Progress is reported to stderr as tasks complete
+    //
+    // 保証:
+    //   - 各タスクはレコードを自身のファイル（OutputManifest::taskFileName）に
+    //     直接書き込む。出力はメモリに保持されず、タスクが他のタスクを待つことはない
+    //   - 正規の順序でファイルを連結すると run の出力を再現する
+    //   - タスクが完了するたびに stderr に進捗を報告する
+    //
+    // ------------------------------------------------------------------------
+    std::vector<TaskStats> runToFiles(const std::vector<SearchTask>& tasks,
+                                      const std::vector<int>& schedule,
+                                      const std::string& output_dir,
+                                      std::vector<TaskFile>& files) const {
+        std::vector<TaskStats> stats(tasks.size());
+        files.assign(tasks.size(), TaskFile());
+        std::atomic<bool> failed{false};
+        std::mutex mutex;
+        size_t completed = 0;
+        size_t report_every = std::max<size_t>(1, tasks.size() / 10);
+
+        parallelFor(schedule.size(), [&](size_t k, int) {
+            if (failed) return;
+            int idx = schedule[k];
+            const SearchTask& task = tasks[idx];
+            TaskFile& file = files[idx];
+            file.path = OutputManifest::taskFileName(task.root_index, task.first_branch);
+            file.root_index = task.root_index;
+            file.base_face = task.base_face;
+            file.base_edge = task.base_edge;
+            file.first_branch = task.first_branch;
+
+            ChecksumFileBuf buf;
+            std::string path = output_dir + "/" + file.path;
+            if (!buf.open(path)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                std::cerr << "Error: Cannot open output file: " << path << "\n";
+                failed = true;
+                return;
+            }
+            std::ostream out(&buf);
+            TaskStats task_stats = runTask(task, out);
+            out.flush();
+            bool written = buf.close();
+            file.num_records = buf.lines();
+            file.num_bytes = buf.bytes();
+            file.checksum = buf.checksum();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!written) {
+                std::cerr << "Error: Cannot write output file: " << path << "\n";
+                failed = true;
+                return;
+            }
+            stats[idx] = task_stats;
+            ++completed;
+            if (completed % report_every == 0 || completed == tasks.size()) {
+                std::cerr << "Info: Completed " << completed << "/" << tasks.size() << " tasks\n";
+            }
+        });
+
+        if (failed) {
+            return {};
+        }
+        return stats;
+    }
+
+    // ------------------------------------------------------------------------
+    // runTopK
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   tasks    : Tasks in canonical order (see planTasks)
+    //   schedule : Execution order (see scheduleTasks)
+    //   k        : Number of candidates to keep (>= 1)
+    //   best     : Reference to store the best candidates
+    //
+    // 入力:
+    //   tasks    : 正規の順序のタスク列（planTasks を参照）
+    //   schedule : 実行順序（scheduleTasks を参照）
+    //   k        : 保持する候補数（1 以上）
+    //   best     : 上位の候補を格納する参照
+    //
+    // Output:
+    //   Measured statistics for each task (indexed like tasks).
+    //   best holds at most k candidates in ranking order (see TopKCandidate).
+    //
+    // 出力:
+    //   各タスクの計測統計（tasks と同じ添字）。
+    //   best には順位順に最大 k 個の候補が格納される（TopKCandidate を参照）。
+    //
+    // Guarantee:
+    //   - Each worker keeps its own TopKCollector (created on the worker's
+    //     thread); all share one threshold, so a tight candidate found by any
+    //     worker prunes every worker
+    //   - best is identical for any number of threads
+    //   - Progress is reported to stderr with the current threshold
+    //
+    // 保証:
+    //   - 各ワーカーは自身の TopKCollector（ワーカーのスレッド上で生成）を持ち、
+    //     閾値はすべてで共有するため、
+    //     いずれかのワーカーが見つけた厳しい候補が全ワーカーの枝刈りに効く
+    //   - best はスレッド数によらず同一
+    //   - 現在の閾値とともに stderr に進捗を報告する
+    //
+    // ------------------------------------------------------------------------
+    std::vector<TaskStats> runTopK(const std::vector<SearchTask>& tasks,
+                                   const std::vector<int>& schedule,
+                                   size_t k,
+                                   std::vector<TopKCandidate>& best) const {
+        std::vector<TaskStats> stats(tasks.size());
+        TopKThreshold threshold;
+        std::vector<std::unique_ptr<TopKCollector>> collectors(num_threads);
+        std::mutex mutex;
+        size_t completed = 0;
+        size_t report_every = std::max<size_t>(1, tasks.size() / 10);
+
+        parallelFor(schedule.size(), [&](size_t i, int t) {
+            if (!collectors[t]) {
+                collectors[t] = std::make_unique<TopKCollector>(k, threshold);
+            }
+            TopKCollector& collector = *collectors[t];
+            int idx = schedule[i];
+            const SearchTask& task = tasks[idx];
+            collector.setRoot(task.root_index, task.base_face, task.base_edge);
+
+            auto start = std::chrono::steady_clock::now();
+            std::ostringstream unused;
+            RotationalUnfolding rot_ufd(polyhedron, task.base_face, task.base_edge,
+                                        symmetric, symmetric, options);
+            rot_ufd.runRotationalUnfolding(unused, task.first_branch, &collector);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            stats[idx] = {rot_ufd.nodeCount(), elapsed.count()};
+            ++completed;
+            if (completed % report_every == 0 || completed == tasks.size()) {
+                std::cerr << "Info: Completed " << completed << "/" << tasks.size()
+                          << " tasks (K-th best circle gap: " << threshold.get() << ")\n";
+            }
+        });
+
+        std::vector<std::vector<TopKCandidate>> kept;
+        for (auto& collector : collectors) {
+            if (collector) kept.push_back(collector->takeCandidates());
+        }
+        best = mergeTopK(std::move(kept), k);
+        return stats;
+    }
+
+private:
+    // Reference to the polyhedron structure (immutable, shared by all workers)
+    // 多面体構造への参照（不変、全ワーカーで共有）
+    const Polyhedron& polyhedron;
+
+    // Whether symmetry pruning is enabled
+    // 対称性枝刈りが有効か
+    bool symmetric;
+
+    // Search options passed to every RotationalUnfolding
+    // すべての RotationalUnfolding に渡す探索オプション
+    SearchOptions options;
+
+    // Number of worker threads
+    // ワーカースレッド数
+    int num_threads;
+
+    // CPU and node of each worker (see CpuTopology::planWorkers)
+    // 各ワーカーの CPU とノード（CpuTopology::planWorkers を参照）
+    CpuTopology::WorkerPlan placement;
+
+    // ------------------------------------------------------------------------
+    // runTask
+    // ------------------------------------------------------------------------
+    //
+    // Runs a single task, writing its records to out, and returns its cost.
+    // 1つのタスクを実行してレコードを out に書き込み、そのコストを返す。
+    //
+    // ------------------------------------------------------------------------
+    TaskStats runTask(const SearchTask& task, std::ostream& out) const {
+        auto start = std::chrono::steady_clock::now();
+
+        RotationalUnfolding rot_ufd(polyhedron, task.base_face, task.base_edge,
+                                    symmetric, symmetric, options);
+        rot_ufd.runRotationalUnfolding(out, task.first_branch);
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return {rot_ufd.nodeCount(), elapsed.count()};
+    }
+
+    // ------------------------------------------------------------------------
+    // finishTask
+    // ------------------------------------------------------------------------
+    //
+    // Called after the output of task idx has been written. When idx is the
+    // last task of its root pair, flushes the output and reports progress
+    // (every 10 root pairs, and always the first and last).
+    //
+    // タスク idx の出力が書き込まれた後に呼ばれる。idx がその root pair の
+    // 最後のタスクであれば、出力をフラッシュして進捗を報告する
+    // （10ペアごと、および最初と最後は必ず）。
+    //
+    // ------------------------------------------------------------------------
+    static void finishTask(const std::vector<SearchTask>& tasks,
+                           int idx,
+                           int num_roots,
+                           int& roots_written,
+                           std::ostream& out) {
+        bool last_of_root = idx + 1 == static_cast<int>(tasks.size())
+                         || tasks[idx + 1].root_index != tasks[idx].root_index;
+        if (!last_of_root) return;
+
+        out.flush();
+        ++roots_written;
+        if (roots_written % 10 == 0 || roots_written == 1 || roots_written == num_roots) {
+            std::cerr << "Info: Processing " << roots_written << "/" << num_roots << "\n";
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // stopped / stopIfFailed
+    // ------------------------------------------------------------------------
+    //
+    // Whether SearchOptions::stop is set, and sets it once out has failed.
+    // SearchOptions::stop が設定されているか、および out が失敗した時点でそれを設定する。
+    //
+    // ------------------------------------------------------------------------
+    bool stopped() const {
+        return options.stop != nullptr && options.stop->load(std::memory_order_relaxed);
+    }
+
+    void stopIfFailed(const std::ostream& out) const {
+        if (!out.good() && options.stop != nullptr) {
+            options.stop->store(true);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // parallelFor
+    // ------------------------------------------------------------------------
+    //
+    // Calls body(i, t) for i in [0, n) on the worker threads, where t is the
+    // index of the calling worker. Items are taken in order through a
+    // NodeWorkQueue, and the remaining items are skipped once
+    // SearchOptions::stop is set; with workers on more than one NUMA node,
+    // the work done on each node is reported to stderr.
+    // i ∈ [0, n) について body(i, t) をワーカースレッド上で呼び出す（t は呼び出した
+    // ワーカーの番号）。項目は NodeWorkQueue を通して順に取り出され、
+    // SearchOptions::stop が設定されると残りの項目は飛ばされる。ワーカーが
+    // 複数の NUMA ノードにある場合は、各ノードで行った作業を stderr に報告する。
+    //
+    // ------------------------------------------------------------------------
+    template <typename Body>
+    void parallelFor(size_t n, Body body) const {
+        int count = static_cast<int>(std::min<size_t>(num_threads, n));
+        if (count == 0) return;
+
+        // Only nodes with a worker receive items
+        // ワーカーのいるノードのみが項目を受け取る
+        int num_nodes = 0;
+        for (int t = 0; t < count; ++t) {
+            num_nodes = std::max(num_nodes, placement.workers[t].node + 1);
+        }
+        std::vector<std::vector<int>> victims(num_nodes);
+        for (int q = 0; q < num_nodes; ++q) {
+            for (int v : placement.victims[q]) {
+                if (v < num_nodes) victims[q].push_back(v);
+            }
+        }
+        NodeWorkQueue queue(n, victims);
+
+        std::vector<double> busy(count, 0.0);
+        std::atomic<bool> pin_failed{false};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < count; ++t) {
+            workers.emplace_back([&, t]() {
+                const CpuTopology::WorkerSlot& slot = placement.workers[t];
+                if (slot.cpu >= 0 && !CpuTopology::pinCurrentThread(slot.cpu)) {
+                    pin_failed = true;
+                }
+                size_t i;
+                while (queue.pop(slot.node, i)) {
+                    if (stopped()) break;
+                    auto start = std::chrono::steady_clock::now();
+                    body(i, t);
+                    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                    busy[t] += elapsed.count();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        if (pin_failed) {
+            std::cerr << "Warning: Could not pin some worker threads to their CPUs\n";
+        }
+        if (num_nodes > 1) {
+            for (int q = 0; q < num_nodes; ++q) {
+                int node_workers = 0;
+                double node_busy = 0.0;
+                for (int t = 0; t < count; ++t) {
+                    if (placement.workers[t].node != q) continue;
+                    ++node_workers;
+                    node_busy += busy[t];
+                }
+                std::cerr << "Info: NUMA node " << placement.node_ids[q] << ": "
+                          << node_workers << " workers, " << queue.localItems(q) << " local + "
+                          << queue.stolenItems(q) << " stolen items, " << node_busy << " s busy\n";
+            }
+        }
+    }
+};
+
+#endif  // REORG_PARALLEL_RUNNER_HPP
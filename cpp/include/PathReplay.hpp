@@ -0,0 +1,261 @@
+// ============================================================================
+// PathReplay.hpp
+// ============================================================================
+//
+// What this file does:
+//   Validates a partial unfolding record by replaying its (face_id, edge_id)
+//   sequence on the polyhedron with the placement rules of the search, and
+//   comparing the recomputed coordinates with the recorded ones.
+//
+// このファイルの役割:
+//   部分展開図レコードの (face_id, edge_id) 列を探索と同じ配置規則で多面体上に
+//   再生し、再計算した座標を記録された座標と比較することでレコードを検証する。
+//
+// Responsibility in the project:
+//   - Checks that the path starts at the recorded base pair
+//   - Checks face IDs, gons, and edge adjacency against the polyhedron
+//   - Checks that no face is used twice
+//   - Checks x, y, and angle_deg of every face within a tolerance
+//   - Does NOT check whether the record should have been emitted
+//
+// プロジェクト内での責務:
+//   - パスが記録された基準ペアから始まることを確認
+//   - 面ID、角数、辺の隣接関係を多面体と照合
+//   - 同じ面が2回使われていないことを確認
+//   - 各面の x, y, angle_deg を許容誤差内で照合
+//   - レコードを出力すべきだったかどうかは確認しない
+//
+// Phase 1 における位置づけ:
+//   Independent check of Phase 1 outputs (and of records carried into
+//   Phases 2 and 3), used to gate changes to the engine or output format.
+//   The placement arithmetic is shared with RotationalUnfolding (Placement),
+//   so a correct record reproduces up to the rounding of the output.
+//   Phase 1 出力（および Phase 2・3 に引き継がれたレコード）の独立した検査であり、
+//   エンジンや出力形式の変更を検証するために使用する。配置計算は
+//   RotationalUnfolding と共有している（Placement）ため、正しいレコードは
+//   出力の丸めの範囲で再現される。
+//
+// ============================================================================
+
+#ifndef REORG_PATH_REPLAY_HPP
+#define REORG_PATH_REPLAY_HPP
+
+#include "Polyhedron.hpp"
+#include "Placement.hpp"
+#include "GeometryUtil.hpp"
+#include "RecordReader.hpp"
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace PathReplay {
+
+// ----------------------------------------------------------------------------
+// Default tolerance for coordinates: the output is rounded to 6 decimal
+// places (error <= 5e-7), plus a margin for the rounding itself.
+// 座標の既定の許容誤差: 出力は小数点以下6桁に丸められる（誤差 5e-7 以下）ため、
+// 丸め自体の余裕を加えた値。
+// ----------------------------------------------------------------------------
+constexpr double DEFAULT_TOLERANCE = 1e-6;
+
+// ============================================================================
+// ReplayError
+// ============================================================================
+//
+// First inconsistency found in a record.
+// レコードで最初に見つかった不整合。
+//
+// ============================================================================
+struct ReplayError {
+    int face_index;       // Index in faces of the failed face (-1 if none)
+    std::string check;    // "base_pair", "face_id", "gon", "repeated_face",
+                          // "adjacency", "x", "y", or "angle_deg"
+    std::string detail;   // Human-readable description
+};
+
+// ----------------------------------------------------------------------------
+// angleDifference (internal)
+// ----------------------------------------------------------------------------
+//
+// Difference of two angles in degrees, wrapped to [-180, 180], so that
+// -180 and 180 compare equal.
+// 2つの角度（度）の差を [-180, 180] に折り返したもの。-180 と 180 は等しくなる。
+//
+// ----------------------------------------------------------------------------
+inline double angleDifference(double a, double b) {
+    double d = std::fmod(a - b, 360.0);
+    if (d > 180.0) d -= 360.0;
+    if (d < -180.0) d += 360.0;
+    return d;
+}
+
+// ----------------------------------------------------------------------------
+// checkPlacement (internal)
+// ----------------------------------------------------------------------------
+inline bool checkPlacement(const UnfoldedFace& face, int index,
+                           double x, double y, double angle,
+                           double tolerance, ReplayError& error) {
+    const char* names[3] = {"x", "y", "angle_deg"};
+    double expected[3] = {x, y, angle};
+    double recorded[3] = {face.x, face.y, face.angle};
+    for (int c = 0; c < 3; ++c) {
+        double diff = (c == 2) ? angleDifference(recorded[c], expected[c])
+                               : recorded[c] - expected[c];
+        if (!(std::fabs(diff) <= tolerance)) {
+            std::ostringstream oss;
+            oss.precision(9);
+            oss << "expected " << expected[c] << ", recorded " << recorded[c];
+            error = {index, names[c], oss.str()};
+            return false;
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// replayRecord
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   poly      : Polyhedron the record was generated from
+//   record    : Parsed partial unfolding record
+//   tolerance : Maximum absolute difference for x, y, and angle_deg
+//   error     : Reference to store the first inconsistency
+//
+// 入力:
+//   poly      : レコードの生成元の多面体
+//   record    : 解析済みの部分展開図レコード
+//   tolerance : x, y, angle_deg の許容される最大絶対差
+//   error     : 最初の不整合を格納する参照
+//
+// Output:
+//   Returns true if the record is consistent with the polyhedron and its own
+//   path; false otherwise (error describes the first failed check).
+//
+// 出力:
+//   レコードが多面体および自身のパスと整合していれば true、そうでなければ
+//   false を返す（error に最初に失敗した検査が記述される）。
+//
+// Guarantee:
+//   - Faces are placed from the replayed (not the recorded) coordinates of
+//     the previous face, so errors do not accumulate along the path
+//   - For faces after the base face, the recorded edge_id must be an edge
+//     shared by the face and the previous face, reached by rotating from
+//     the previous face's entry edge exactly as the search does
+//   - No side effects
+//
+// 保証:
+//   - 各面は直前の面の（記録値ではなく）再生した座標から配置されるため、
+//     誤差がパスに沿って蓄積しない
+//   - 基準面以降の面について、記録された edge_id はその面と直前の面が共有する
+//     辺であり、探索と同様に直前の面の入辺から回転して到達できなければならない
+//   - 副作用なし
+//
+// ----------------------------------------------------------------------------
+inline bool replayRecord(const Polyhedron& poly,
+                         const ParsedRecord& record,
+                         double tolerance,
+                         ReplayError& error) {
+    const std::vector<UnfoldedFace>& faces = record.faces;
+
+    if (faces[0].face_id != record.base_face || faces[0].edge_id != record.base_edge) {
+        error = {0, "base_pair", "first face does not match base_pair"};
+        return false;
+    }
+
+    std::vector<bool> used(poly.num_faces, false);
+    for (size_t k = 0; k < faces.size(); ++k) {
+        int index = static_cast<int>(k);
+        const UnfoldedFace& face = faces[k];
+        if (face.face_id < 0 || face.face_id >= poly.num_faces) {
+            error = {index, "face_id", "face_id " + std::to_string(face.face_id) + " out of range"};
+            return false;
+        }
+        if (face.gon != poly.gon_list[face.face_id]) {
+            error = {index, "gon", "gon " + std::to_string(face.gon) + ", polyhedron has "
+                                   + std::to_string(poly.gon_list[face.face_id])};
+            return false;
+        }
+        if (used[face.face_id]) {
+            error = {index, "repeated_face", "face " + std::to_string(face.face_id) + " used twice"};
+            return false;
+        }
+        used[face.face_id] = true;
+        if (poly.getEdgeIndex(face.face_id, face.edge_id) < 0) {
+            error = {index, "adjacency", "edge " + std::to_string(face.edge_id)
+                                         + " is not an edge of face " + std::to_string(face.face_id)};
+            return false;
+        }
+    }
+
+    // Base face: origin, angle 0
+    // 基準面: 原点、角度 0
+    if (!checkPlacement(faces[0], 0, 0.0, 0.0, 0.0, tolerance, error)) {
+        return false;
+    }
+    if (faces.size() == 1) {
+        return true;
+    }
+
+    // Second face: across the base edge
+    // 2番目の面: 基準辺を挟んだ隣
+    int base_edge_pos = poly.getEdgeIndex(record.base_face, record.base_edge);
+    if (poly.adj_faces[record.base_face][base_edge_pos] != faces[1].face_id
+        || faces[1].edge_id != record.base_edge) {
+        error = {1, "adjacency", "second face is not across the base edge"};
+        return false;
+    }
+
+    double x, y, angle;
+    Placement::placeSecondFace(faces[0].gon, faces[1].gon, x, y, angle);
+    GeometryUtil::normalizeAngle(angle);
+    if (!checkPlacement(faces[1], 1, x, y, angle, tolerance, error)) {
+        return false;
+    }
+
+    // Remaining faces: rotate from the entry edge of the previous face to the
+    // shared edge, then place across it
+    // 残りの面: 直前の面の入辺から共有辺まで回転し、その辺を挟んで配置する
+    for (size_t k = 2; k < faces.size(); ++k) {
+        int index = static_cast<int>(k);
+        const UnfoldedFace& prev = faces[k - 1];
+        const UnfoldedFace& face = faces[k];
+
+        Placement::suppressNoise(x);
+        Placement::suppressNoise(y);
+
+        int entry_pos = poly.getEdgeIndex(prev.face_id, prev.edge_id);
+        double next_angle = angle;
+        bool found = false;
+        for (int i = entry_pos + 1; i < entry_pos + prev.gon; ++i) {
+            Placement::advanceEdge(next_angle, prev.gon);
+            if (poly.adj_edges[prev.face_id][i % prev.gon] == face.edge_id) {
+                found = poly.adj_faces[prev.face_id][i % prev.gon] == face.face_id;
+                break;
+            }
+        }
+        if (!found) {
+            error = {index, "adjacency", "face " + std::to_string(face.face_id)
+                                         + " is not adjacent to face " + std::to_string(prev.face_id)
+                                         + " across edge " + std::to_string(face.edge_id)};
+            return false;
+        }
+
+        double next_x, next_y;
+        Placement::placeAdjacentFace(x, y, next_angle, prev.gon, face.gon, next_x, next_y);
+        x = next_x;
+        y = next_y;
+        angle = next_angle - 180.0;
+        GeometryUtil::normalizeAngle(angle);
+        if (!checkPlacement(face, index, x, y, angle, tolerance, error)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}  // namespace PathReplay
+
+#endif  // REORG_PATH_REPLAY_HPP
@@ -0,0 +1,164 @@
+// ============================================================================
+// Placement.hpp
+// ============================================================================
+//
+// What this file does:
+//   Provides the placement rules that determine where each face of a
+//   path-shaped partial unfolding is put on the plane.
+//
+// このファイルの役割:
+//   パス状の部分展開図の各面を平面上のどこに置くかを決める配置規則を提供する。
+//
+// Responsibility in the project:
+//   - Places the second face next to the base face
+//   - Rotates the outgoing direction from one edge of a face to the next
+//   - Places a face adjacent to the current face across a shared edge
+//   - Does NOT manage the search, pruning, or output
+//
+// プロジェクト内での責務:
+//   - 2番目の面を基準面の隣に配置
+//   - 面のある辺から次の辺へ出ていく方向を回転
+//   - 共有辺を挟んで現在の面に隣接する面を配置
+//   - 探索、枝刈り、出力の管理は担当しない
+//
+// Phase 1 における位置づけ:
+//   Single definition of the placement arithmetic shared by the search
+//   (RotationalUnfolding) and the replay validator (PathReplay), so that
+//   both compute bit-identical coordinates for the same path.
+//   Phase 1では、探索（RotationalUnfolding）と再生検証器（PathReplay）が共有する
+//   配置計算の唯一の定義。同じパスに対して両者がビット単位で同一の座標を計算する。
+//
+// ============================================================================
+
+#ifndef REORG_PLACEMENT_HPP
+#define REORG_PLACEMENT_HPP
+
+#include "GeometryUtil.hpp"
+#include <cmath>
+
+namespace Placement {
+
+// ----------------------------------------------------------------------------
+// placeSecondFace
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   base_gon   : Gon of the base face
+//   second_gon : Gon of the second face
+//   x, y       : References to store the center of the second face
+//   angle      : Reference to store the angle from the second face back to
+//                the base face
+//
+// 入力:
+//   base_gon   : 基準面の角数
+//   second_gon : 2番目の面の角数
+//   x, y       : 2番目の面の中心を格納する参照
+//   angle      : 2番目の面から基準面へ戻る方向の角度を格納する参照
+//
+// Guarantee:
+//   - The base face is centered at the origin with the base edge
+//     perpendicular to the positive x-axis, so the second face's center is
+//     (inradius(base) + inradius(second), 0)
+//   - The direction back to the base face is the negative x-direction;
+//     angles are in [-180, 180], so the angle is -180
+//
+// 保証:
+//   - 基準面の中心は原点、基準辺はx軸正方向に垂直であるため、
+//     2番目の面の中心は (inradius(基準面) + inradius(2番目の面), 0)
+//   - 基準面へ戻る方向はx軸負方向であり、角度は [-180, 180] で表すため -180
+//
+// ----------------------------------------------------------------------------
+inline void placeSecondFace(int base_gon, int second_gon,
+                            double& x, double& y, double& angle) {
+    x = GeometryUtil::inradius(base_gon) + GeometryUtil::inradius(second_gon);
+    y = 0.0;
+    angle = -180.0;
+}
+
+// ----------------------------------------------------------------------------
+// suppressNoise
+// ----------------------------------------------------------------------------
+//
+// Rounds a coordinate smaller than 1e-10 in magnitude to zero to avoid
+// floating-point noise. Applied to a face's center after it is recorded and
+// before its neighbors are placed.
+//
+// 浮動小数点ノイズを避けるため、絶対値が 1e-10 未満の座標を0に丸める。
+// 面の中心を記録した後、その隣接面を配置する前に適用する。
+//
+// ----------------------------------------------------------------------------
+inline void suppressNoise(double& value) {
+    if (std::fabs(value) < 1e-10) value = 0.0;
+}
+
+// ----------------------------------------------------------------------------
+// advanceEdge
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   angle : Direction from the face center toward one of its edges
+//           (modified in-place)
+//   gon   : Gon of the face
+//
+// 入力:
+//   angle : 面の中心からその辺の1つへ向かう方向（その場で変更される）
+//   gon   : 面の角数
+//
+// Guarantee:
+//   - Rotates angle clockwise by one edge (360 / gon degrees) and normalizes
+//     it to [-180, 180]
+//   - Applying it k times to the entry direction yields the direction toward
+//     the k-th edge after the entry edge
+//
+// 保証:
+//   - angle を辺1つ分（360 / gon 度）時計回りに回転し、[-180, 180] に正規化する
+//   - 入ってきた方向に k 回適用すると、入ってきた辺から k 番目の辺への方向になる
+//
+// ----------------------------------------------------------------------------
+inline void advanceEdge(double& angle, int gon) {
+    angle -= 360.0 / static_cast<double>(gon);
+    GeometryUtil::normalizeAngle(angle);
+}
+
+// ----------------------------------------------------------------------------
+// placeAdjacentFace
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   x, y     : Center of the current face
+//   angle    : Direction from the current face toward the shared edge
+//   gon      : Gon of the current face
+//   next_gon : Gon of the adjacent face
+//   next_x   : Reference to store the x-coordinate of the adjacent face
+//   next_y   : Reference to store the y-coordinate of the adjacent face
+//
+// 入力:
+//   x, y     : 現在の面の中心
+//   angle    : 現在の面から共有辺へ向かう方向
+//   gon      : 現在の面の角数
+//   next_gon : 隣接面の角数
+//   next_x   : 隣接面のx座標を格納する参照
+//   next_y   : 隣接面のy座標を格納する参照
+//
+// Guarantee:
+//   - The distance between the two centers is the sum of their inradii,
+//     along the given direction
+//   - The direction from the adjacent face back to the current face is
+//     angle - 180 (normalized when the adjacent face is visited)
+//
+// 保証:
+//   - 2つの中心間の距離は、与えられた方向に沿った両面の内接円半径の合計
+//   - 隣接面から現在の面へ戻る方向は angle - 180
+//     （隣接面を訪問した時点で正規化される）
+//
+// ----------------------------------------------------------------------------
+inline void placeAdjacentFace(double x, double y, double angle, int gon, int next_gon,
+                              double& next_x, double& next_y) {
+    double distance = GeometryUtil::inradius(gon) + GeometryUtil::inradius(next_gon);
+    next_x = x + distance * std::cos(angle * GeometryUtil::PI / 180.0);
+    next_y = y + distance * std::sin(angle * GeometryUtil::PI / 180.0);
+}
+
+}  // namespace Placement
+
+#endif  // REORG_PLACEMENT_HPP
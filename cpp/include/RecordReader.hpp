@@ -0,0 +1,553 @@
+// ============================================================================
+// RecordReader.hpp
+// ============================================================================
+//
+// What this file does:
+//   Provides a fast reader for partial unfolding JSONL files (raw, noniso,
+//   exact). Files are memory-mapped, split into line-aligned chunks for
+//   parallel processing, and each line is parsed by a small scanner that
+//   understands only the partial unfolding record schema.
+//
+// このファイルの役割:
+//   部分展開図の JSONL ファイル（raw, noniso, exact）の高速リーダーを提供する。
+//   ファイルをメモリマップし、並列処理のために行境界で分割されたチャンクに分け、
+//   各行を部分展開図レコードのスキーマのみを理解する小さなスキャナで解析する。
+//
+// Responsibility in the project:
+//   - Memory-maps JSONL files read-only
+//   - Splits a mapped file into line-aligned chunks
+//   - Parses a single record line into a ParsedRecord
+//   - Computes a formatting-independent hash of a record
+//   - Does NOT write or modify JSONL files
+//
+// プロジェクト内での責務:
+//   - JSONL ファイルを読み取り専用でメモリマップ
+//   - マップしたファイルを行境界で揃えたチャンクに分割
+//   - 1行のレコードを ParsedRecord に解析
+//   - 書式に依存しないレコードのハッシュを計算
+//   - JSONL ファイルの書き込みや変更は行わない
+//
+// Phase 1 における位置づけ:
+//   Input layer of the native tools that inspect pipeline outputs
+//   (statistics, diff, validation). Accepts both the compact C++ output
+//   and the Python-formatted output of Phases 2 and 3.
+//   Phase 1では、パイプライン出力を検査するネイティブツール
+//   （統計、差分、検証）の入力層。C++ のコンパクトな出力と、
+//   Phase 2・3 の Python 形式の出力の両方を受け付ける。
+//
+// ============================================================================
+
+#ifndef REORG_RECORD_READER_HPP
+#define REORG_RECORD_READER_HPP
+
+#include "UnfoldedFace.hpp"
+#include "HashUtil.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ============================================================================
+// ParsedRecord
+// ============================================================================
+//
+// A partial unfolding record as read from a JSONL file.
+// JSONL ファイルから読み込んだ部分展開図レコード。
+//
+// ============================================================================
+struct ParsedRecord {
+    int base_face = -1;                 // base_pair.base_face
+    int base_edge = -1;                 // base_pair.base_edge
+    bool symmetric_used = false;        // symmetric_used
+    std::vector<UnfoldedFace> faces;    // faces (angle holds angle_deg)
+};
+
+// ============================================================================
+// MappedFile
+// ============================================================================
+//
+// Read-only memory mapping of a whole file.
+// ファイル全体の読み取り専用メモリマップ。
+//
+// Responsibility:
+//   - Maps the file on open and unmaps it on destruction
+//   - Exposes the contents as a (data, size) byte range
+//
+// 責務:
+//   - open でファイルをマップし、破棄時にアンマップする
+//   - 内容を (data, size) のバイト範囲として公開する
+//
+// ============================================================================
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (mapped != nullptr) {
+            munmap(mapped, length);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // open
+    // ------------------------------------------------------------------------
+    //
+    // Maps the file at path. Returns true on success, false if the file
+    // cannot be opened or mapped. An empty file is opened successfully
+    // with size() == 0.
+    //
+    // path のファイルをマップする。成功時は true、開けない・マップできない
+    // 場合は false を返す。空のファイルは size() == 0 として正常に開かれる。
+    //
+    // ------------------------------------------------------------------------
+    bool open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        length = static_cast<size_t>(st.st_size);
+        if (length > 0) {
+            void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                return false;
+            }
+            mapped = p;
+            madvise(mapped, length, MADV_SEQUENTIAL);
+        }
+
+        ::close(fd);
+        return true;
+    }
+
+    const char* data() const { return static_cast<const char*>(mapped); }
+    size_t size() const { return length; }
+
+private:
+    void* mapped = nullptr;
+    size_t length = 0;
+};
+
+namespace RecordReader {
+
+// ============================================================================
+// Chunking
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// Chunk
+// ----------------------------------------------------------------------------
+//
+// Half-open byte range [begin, end) of a mapped file that starts at the
+// beginning of a line and ends just after a newline (or at end of file).
+//
+// マップしたファイルの半開バイト範囲 [begin, end)。行頭から始まり、
+// 改行の直後（またはファイル末尾）で終わる。
+//
+// ----------------------------------------------------------------------------
+struct Chunk {
+    size_t begin;
+    size_t end;
+};
+
+// ----------------------------------------------------------------------------
+// splitIntoChunks
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   data       : Pointer to the file contents
+//   size       : Size of the file contents
+//   num_chunks : Desired number of chunks (>= 1)
+//
+// 入力:
+//   data       : ファイル内容へのポインタ
+//   size       : ファイル内容のサイズ
+//   num_chunks : 希望するチャンク数（1 以上）
+//
+// Output:
+//   At most num_chunks non-empty, line-aligned chunks covering the whole file
+//   in order.
+//
+// 出力:
+//   ファイル全体を順に覆う、行境界で揃えた空でないチャンク（最大 num_chunks 個）。
+//
+// ----------------------------------------------------------------------------
+inline std::vector<Chunk> splitIntoChunks(const char* data, size_t size, int num_chunks) {
+    std::vector<Chunk> chunks;
+    size_t begin = 0;
+    for (int c = 1; c <= num_chunks && begin < size; ++c) {
+        size_t end = (c == num_chunks) ? size : size / num_chunks * c;
+        if (end <= begin) continue;
+        const void* nl = std::memchr(data + end - 1, '\n', size - (end - 1));
+        end = (nl == nullptr) ? size : static_cast<size_t>(static_cast<const char*>(nl) - data) + 1;
+        chunks.push_back({begin, end});
+        begin = end;
+    }
+    return chunks;
+}
+
+// ----------------------------------------------------------------------------
+// forEachLine
+// ----------------------------------------------------------------------------
+//
+// Calls body(line, length) for each non-empty line of the chunk, without the
+// trailing newline (and without a trailing '\r').
+//
+// チャンク内の空でない各行について body(line, length) を呼び出す。
+// 末尾の改行（および末尾の '\r'）は含まない。
+//
+// ----------------------------------------------------------------------------
+template <typename Body>
+inline void forEachLine(const char* data, const Chunk& chunk, Body body) {
+    size_t pos = chunk.begin;
+    while (pos < chunk.end) {
+        const void* nl = std::memchr(data + pos, '\n', chunk.end - pos);
+        size_t line_end = (nl == nullptr) ? chunk.end
+                                          : static_cast<size_t>(static_cast<const char*>(nl) - data);
+        size_t len = line_end - pos;
+        if (len > 0 && data[pos + len - 1] == '\r') --len;
+        if (len > 0) {
+            body(data + pos, len);
+        }
+        pos = line_end + 1;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// forEachChunkParallel
+// ----------------------------------------------------------------------------
+//
+// Calls body(chunk_index, chunk) for every chunk, one thread per chunk.
+// Results should be collected per chunk and merged by the caller in chunk
+// order, which keeps them independent of thread timing.
+//
+// 各チャンクについて、チャンクごとに1スレッドで body(chunk_index, chunk) を
+// 呼び出す。結果はチャンクごとに収集し、呼び出し側でチャンク順にマージすること。
+// これにより結果はスレッドのタイミングに依存しない。
+//
+// ----------------------------------------------------------------------------
+template <typename Body>
+inline void forEachChunkParallel(const std::vector<Chunk>& chunks, Body body) {
+    if (chunks.size() <= 1) {
+        for (size_t i = 0; i < chunks.size(); ++i) body(i, chunks[i]);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        workers.emplace_back([&body, &chunks, i]() { body(i, chunks[i]); });
+    }
+    for (auto& w : workers) w.join();
+}
+
+// ============================================================================
+// Record Parsing
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// Scanner
+// ----------------------------------------------------------------------------
+//
+// Minimal cursor over one JSON line. Understands just enough JSON to read
+// the partial unfolding schema and to skip any other value.
+// 1行の JSON 上の最小限のカーソル。部分展開図スキーマを読み、
+// それ以外の値を読み飛ばすのに必要な分だけ JSON を理解する。
+//
+// ----------------------------------------------------------------------------
+struct Scanner {
+    const char* p;
+    const char* end;
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    // Reads a string without escapes (all keys of the schema are plain ASCII)
+    // エスケープを含まない文字列を読む（スキーマのキーはすべて ASCII）
+    bool readKey(const char*& key, size_t& len) {
+        if (!consume('"')) return false;
+        key = p;
+        while (p < end && *p != '"') {
+            if (*p == '\\') ++p;
+            ++p;
+        }
+        if (p >= end) return false;
+        len = static_cast<size_t>(p - key);
+        ++p;
+        return consume(':');
+    }
+
+    // Copies the number into a local NUL-terminated buffer before parsing:
+    // the mapped file is not NUL-terminated, so strtod must not read [p, end)
+    // directly
+    // 数値をローカルの NUL 終端バッファにコピーしてから解析する：
+    // マップしたファイルは NUL 終端されていないため、strtod に [p, end) を
+    // 直接読ませてはならない
+    bool readNumber(double& value) {
+        skipSpace();
+        char buf[64];
+        size_t len = 0;
+        while (p + len < end && len < sizeof(buf) - 1) {
+            char c = p[len];
+            if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) break;
+            buf[len++] = c;
+        }
+        if (len == 0 || len == sizeof(buf) - 1) return false;
+        buf[len] = '\0';
+        char* next = nullptr;
+        value = std::strtod(buf, &next);
+        if (next == buf) return false;
+        p += next - buf;
+        return true;
+    }
+
+    bool readInt(int& value) {
+        double v;
+        if (!readNumber(v)) return false;
+        value = static_cast<int>(v);
+        return true;
+    }
+
+    bool readBool(bool& value) {
+        skipSpace();
+        if (end - p >= 4 && std::memcmp(p, "true", 4) == 0) {
+            value = true;
+            p += 4;
+            return true;
+        }
+        if (end - p >= 5 && std::memcmp(p, "false", 5) == 0) {
+            value = false;
+            p += 5;
+            return true;
+        }
+        return false;
+    }
+
+    // Skips any JSON value (string, number, literal, object, or array)
+    // 任意の JSON 値（文字列、数値、リテラル、オブジェクト、配列）を読み飛ばす
+    bool skipValue() {
+        skipSpace();
+        if (p >= end) return false;
+        if (*p == '"') {
+            ++p;
+            while (p < end && *p != '"') {
+                if (*p == '\\') ++p;
+                ++p;
+            }
+            if (p >= end) return false;
+            ++p;
+            return true;
+        }
+        if (*p == '{' || *p == '[') {
+            int depth = 0;
+            bool in_string = false;
+            for (; p < end; ++p) {
+                char c = *p;
+                if (in_string) {
+                    if (c == '\\') ++p;
+                    else if (c == '"') in_string = false;
+                } else if (c == '"') {
+                    in_string = true;
+                } else if (c == '{' || c == '[') {
+                    ++depth;
+                } else if (c == '}' || c == ']') {
+                    if (--depth == 0) {
+                        ++p;
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+        while (p < end && *p != ',' && *p != '}' && *p != ']') ++p;
+        return true;
+    }
+
+    static bool keyIs(const char* key, size_t len, const char* name) {
+        return std::strlen(name) == len && std::memcmp(key, name, len) == 0;
+    }
+};
+
+// ----------------------------------------------------------------------------
+// parseFace (internal)
+// ----------------------------------------------------------------------------
+inline bool parseFace(Scanner& s, UnfoldedFace& face) {
+    face = {-1, 0, -1, 0.0, 0.0, 0.0};
+    if (!s.consume('{')) return false;
+    if (s.consume('}')) return true;
+    do {
+        const char* key;
+        size_t len;
+        if (!s.readKey(key, len)) return false;
+        bool ok;
+        if (Scanner::keyIs(key, len, "face_id")) ok = s.readInt(face.face_id);
+        else if (Scanner::keyIs(key, len, "gon")) ok = s.readInt(face.gon);
+        else if (Scanner::keyIs(key, len, "edge_id")) ok = s.readInt(face.edge_id);
+        else if (Scanner::keyIs(key, len, "x")) ok = s.readNumber(face.x);
+        else if (Scanner::keyIs(key, len, "y")) ok = s.readNumber(face.y);
+        else if (Scanner::keyIs(key, len, "angle_deg")) ok = s.readNumber(face.angle);
+        else ok = s.skipValue();
+        if (!ok) return false;
+    } while (s.consume(','));
+    return s.consume('}');
+}
+
+// ----------------------------------------------------------------------------
+// parseRecord
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   line   : Pointer to the first character of a JSONL line
+//   length : Length of the line (without newline)
+//   record : Reference to a ParsedRecord to be filled
+//
+// 入力:
+//   line   : JSONL 行の先頭文字へのポインタ
+//   length : 行の長さ（改行を含まない）
+//   record : 結果を格納する ParsedRecord への参照
+//
+// Output:
+//   Returns true if the line is a well-formed partial unfolding record with
+//   base_pair and a non-empty faces array; false otherwise.
+//
+// 出力:
+//   行が base_pair と空でない faces 配列を持つ正しい部分展開図レコードであれば
+//   true、それ以外は false を返す。
+//
+// Guarantee:
+//   - Accepts any key order and any whitespace between tokens
+//   - Ignores unknown keys (e.g., exact_overlap, endpoint_slack)
+//   - record.faces is reused (cleared) to avoid reallocation in loops
+//
+// 保証:
+//   - 任意のキー順序とトークン間の任意の空白を受け付ける
+//   - 未知のキー（例: exact_overlap, endpoint_slack）は無視する
+//   - ループ内での再確保を避けるため、record.faces は再利用（クリア）される
+//
+// ----------------------------------------------------------------------------
+inline bool parseRecord(const char* line, size_t length, ParsedRecord& record) {
+    Scanner s{line, line + length};
+    record.base_face = -1;
+    record.base_edge = -1;
+    record.symmetric_used = false;
+    record.faces.clear();
+
+    if (!s.consume('{')) return false;
+    if (s.consume('}')) return false;
+    do {
+        const char* key;
+        size_t len;
+        if (!s.readKey(key, len)) return false;
+        bool ok = true;
+        if (Scanner::keyIs(key, len, "base_pair")) {
+            if (!s.consume('{')) return false;
+            do {
+                const char* k;
+                size_t kl;
+                if (!s.readKey(k, kl)) return false;
+                if (Scanner::keyIs(k, kl, "base_face")) ok = s.readInt(record.base_face);
+                else if (Scanner::keyIs(k, kl, "base_edge")) ok = s.readInt(record.base_edge);
+                else ok = s.skipValue();
+                if (!ok) return false;
+            } while (s.consume(','));
+            ok = s.consume('}');
+        }
+        else if (Scanner::keyIs(key, len, "symmetric_used")) {
+            ok = s.readBool(record.symmetric_used);
+        }
+        else if (Scanner::keyIs(key, len, "faces")) {
+            if (!s.consume('[')) return false;
+            if (!s.consume(']')) {
+                do {
+                    UnfoldedFace face;
+                    if (!parseFace(s, face)) return false;
+                    record.faces.push_back(face);
+                } while (s.consume(','));
+                ok = s.consume(']');
+            }
+        }
+        else {
+            ok = s.skipValue();
+        }
+        if (!ok) return false;
+    } while (s.consume(','));
+
+    return s.consume('}') && record.base_face >= 0 && record.base_edge >= 0 && !record.faces.empty();
+}
+
+// ----------------------------------------------------------------------------
+// hashRecord
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   record : Parsed partial unfolding record
+//
+// 入力:
+//   record : 解析済みの部分展開図レコード
+//
+// Output:
+//   64-bit hash of the record's content: base pair, symmetric_used, and for
+//   each face its IDs, gon, and coordinates quantized to 1e-6.
+//
+// 出力:
+//   レコード内容の64ビットハッシュ: 基準ペア、symmetric_used、および各面の
+//   ID・角数・1e-6 単位に量子化した座標。
+//
+// Guarantee:
+//   - Independent of JSON formatting (whitespace, key order, number format,
+//     "-0.000000" vs "0.000000"), so raw.jsonl and Python-written files with
+//     the same content hash equally
+//   - Ignores fields outside the partial unfolding schema
+//
+// 保証:
+//   - JSON の書式（空白、キー順序、数値表記、"-0.000000" と "0.000000"）に
+//     依存しないため、同じ内容の raw.jsonl と Python が書き出したファイルは
+//     同じハッシュになる
+//   - 部分展開図スキーマ外のフィールドは無視する
+//
+// ----------------------------------------------------------------------------
+inline std::uint64_t hashRecord(const ParsedRecord& record) {
+    std::int64_t header[3] = {record.base_face, record.base_edge, record.symmetric_used ? 1 : 0};
+    std::uint64_t h = HashUtil::fnv1a64(header, sizeof(header));
+    for (const auto& f : record.faces) {
+        std::int64_t values[6] = {
+            f.face_id,
+            f.gon,
+            f.edge_id,
+            std::llround(f.x * 1000000.0),
+            std::llround(f.y * 1000000.0),
+            std::llround(f.angle * 1000000.0)
+        };
+        h = HashUtil::fnv1a64(values, sizeof(values), h);
+    }
+    return h;
+}
+
+}  // namespace RecordReader
+
+#endif  // REORG_RECORD_READER_HPP
@@ -0,0 +1,433 @@
+// ============================================================================
+// ReorderBuffer.hpp
+// ============================================================================
+//
+// What this file does:
+//   Holds the output of tasks that finish out of canonical order until it
+//   can be written, keeping at most a fixed number of bytes in memory and
+//   spilling the rest to a temporary file.
+//
+// このファイルの役割:
+//   正規の順序より先に終わったタスクの出力を書き込めるようになるまで保持する。
+//   メモリに保持するのは一定のバイト数までとし、残りは一時ファイルに退避する。
+//   退避ファイルはすべてのタスクで共有する1つのファイルである。
+//
+// Responsibility in the project:
+//   - Receives task output from worker threads in fixed-size chunks
+//   - Keeps chunks in memory up to the memory cap, spills the rest
+//   - Streams each task's chunks to the output in order, as soon as the
+//     task is next in canonical order (even while it is still running)
+//   - Does NOT decide the canonical order or run tasks
+//
+// プロジェクト内での責務:
+//   - ワーカースレッドからタスクの出力を固定サイズのチャンク単位で受け取る
+//   - メモリ上限まではチャンクをメモリに保持し、残りは退避する
+//   - タスクが正規の順序で次になった時点で（実行中であっても）、
+//     そのタスクのチャンクを順に出力へ流す
+//   - 正規の順序の決定やタスクの実行は担当しない
+//
+// Phase 1 における位置づけ:
+//   Output layer of ParallelRunner::run, which keeps the output
+//   byte-identical to a serial run. Without a cap, the output of fast root
+//   pairs piles up in memory behind a slow one; with the cap, peak memory is
+//   bounded by the cap plus one chunk per worker thread.
+//   Phase 1では、出力を逐次実行とバイト単位で一致させる ParallelRunner::run の
+//   出力層。上限がないと、遅い root pair の後ろに速い root pair の出力がメモリに
+//   蓄積する。上限により、ピークメモリは上限とワーカースレッドごとの1チャンクの
+//   合計で抑えられる。
+//
+// ============================================================================
+
+#ifndef REORG_REORDER_BUFFER_HPP
+#define REORG_REORDER_BUFFER_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+// ============================================================================
+// ReorderBuffer
+// ============================================================================
+//
+// Per-task queues of output chunks, shared by the worker threads (producers)
+// and the writing thread (consumer).
+// 出力チャンクのタスクごとのキュー。ワーカースレッド（生産者）と書き込み
+// スレッド（消費者）が共有する。
+//
+// Responsibility:
+//   - Accounts the bytes held in memory against the cap
+//   - Owns one anonymous (unlinked) spill file shared by all tasks, so a run
+//     uses a single descriptor however many tasks are pending
+//
+// 責務:
+//   - メモリに保持しているバイト数を上限と照合して管理
+//   - すべてのタスクで共有する1つの無名（unlink 済み）退避ファイルを所有する。
+//     保留中のタスク数にかかわらず、実行が使うディスクリプタは1つ
+//
+// Does NOT handle:
+//   - Formatting of records (see ReorderStreamBuf)
+//
+// 責務外:
+//   - レコードの書式化（ReorderStreamBuf を参照）
+//
+// ============================================================================
+class ReorderBuffer {
+public:
+    // Size of the chunks handed over by workers (1 MiB)
+    // ワーカーが受け渡すチャンクのサイズ（1 MiB）
+    static constexpr size_t CHUNK_SIZE = size_t(1) << 20;
+
+    // Default memory cap (1 GiB)
+    // 既定のメモリ上限（1 GiB）
+    static constexpr size_t DEFAULT_MEMORY_CAP = size_t(1) << 30;
+
+    // ------------------------------------------------------------------------
+    // Constructor
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   num_tasks  : Number of tasks (slots)
+    //   memory_cap : Maximum bytes of pending output kept in memory
+    //   spill_dir  : Directory for the temporary spill files
+    //
+    // 入力:
+    //   num_tasks  : タスク数（スロット数）
+    //   memory_cap : メモリに保持する未書き込み出力の最大バイト数
+    //   spill_dir  : 一時退避ファイル用のディレクトリ
+    //
+    // ------------------------------------------------------------------------
+    ReorderBuffer(size_t num_tasks, size_t memory_cap, const std::string& spill_dir)
+        : slots(num_tasks), memory_cap(memory_cap), spill_dir(spill_dir) {}
+
+    ReorderBuffer(const ReorderBuffer&) = delete;
+    ReorderBuffer& operator=(const ReorderBuffer&) = delete;
+
+    ~ReorderBuffer() {
+        if (spill_fd >= 0) ::close(spill_fd);
+    }
+
+    // ------------------------------------------------------------------------
+    // append
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   task  : Index of the task that produced the chunk
+    //   chunk : Output chunk (moved from)
+    //
+    // 入力:
+    //   task  : チャンクを生成したタスクの番号
+    //   chunk : 出力チャンク（ムーブされる）
+    //
+    // Guarantee:
+    //   - Chunks of one task are written in the order they were appended
+    //   - The chunk is kept in memory if it fits under the cap; otherwise it
+    //     is appended to the shared spill file (outside the lock)
+    //   - If the spill file cannot be created or written, the run fails: an
+    //     error is printed once, the chunk is dropped, and writeTask returns
+    //     false from then on, so memory never grows past the cap
+    //   - Must be called by one thread per task
+    //
+    // 保証:
+    //   - 1つのタスクのチャンクは追加された順に書き込まれる
+    //   - 上限内に収まればチャンクはメモリに保持され、そうでなければ（ロック外で）
+    //     共有の退避ファイルに追記される
+    //   - 退避ファイルを作成・書き込みできない場合、実行は失敗する: エラーを1度だけ
+    //     出力してチャンクを破棄し、以後 writeTask は false を返す。そのため
+    //     メモリが上限を超えて増えることはない
+    //   - 1つのタスクについては1つのスレッドから呼び出すこと
+    //
+    // ------------------------------------------------------------------------
+    void append(int task, std::string&& chunk) {
+        if (chunk.empty()) return;
+        Slot& slot = slots[task];
+
+        off_t offset = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (spill_failed) return;
+            if (held + chunk.size() <= memory_cap) {
+                pushMemory(slot, std::move(chunk));
+                return;
+            }
+            if (spill_fd < 0) {
+                spill_fd = createSpillFile();
+                if (spill_fd < 0) {
+                    reportSpillFailure();
+                    return;
+                }
+            }
+            offset = spill_size;
+            spill_size += static_cast<off_t>(chunk.size());
+        }
+
+        bool written = writeAll(spill_fd, chunk.data(), chunk.size(), offset);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!written) {
+            reportSpillFailure();
+            return;
+        }
+        slot.segments.push_back({std::string(), offset, chunk.size()});
+        spilled += static_cast<long long>(chunk.size());
+        ready.notify_all();
+    }
+
+    // ------------------------------------------------------------------------
+    // finish
+    // ------------------------------------------------------------------------
+    //
+    // Marks the task as complete (no more chunks will be appended).
+    // タスクを完了済みにする（これ以上チャンクは追加されない）。
+    //
+    // ------------------------------------------------------------------------
+    void finish(int task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots[task].done = true;
+        ready.notify_all();
+    }
+
+    // ------------------------------------------------------------------------
+    // writeTask
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   task : Index of the task to write
+    //   out  : Output stream
+    //
+    // 入力:
+    //   task : 書き込むタスクの番号
+    //   out  : 出力ストリーム
+    //
+    // Output:
+    //   Returns true on success, false if the spill file could not be
+    //   written or read (with an error on std::cerr; out is then marked bad).
+    //
+    // 出力:
+    //   成功時は true、退避ファイルを書き込めなかった、または読めなかった場合は
+    //   false を返す（std::cerr にエラーを出力し、out を bad にする）。
+    //
+    // Guarantee:
+    //   - Writes every chunk of the task, in order, as it becomes available,
+    //     and returns once the task is finished and fully written, or at once
+    //     after a spill failure
+    //   - Releases the memory of the task
+    //
+    // 保証:
+    //   - タスクのすべてのチャンクを、利用可能になり次第順に書き込み、
+    //     タスクが完了してすべて書き込んだ時点で戻る。退避に失敗した後は直ちに戻る
+    //   - タスクのメモリを解放する
+    //
+    // ------------------------------------------------------------------------
+    bool writeTask(int task, std::ostream& out) {
+        Slot& slot = slots[task];
+        bool ok = true;
+        std::vector<char> read_buffer;
+
+        for (;;) {
+            Segment segment;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [&]() {
+                    return !slot.segments.empty() || slot.done || spill_failed;
+                });
+                if (spill_failed) {
+                    out.setstate(std::ios::badbit);
+                    ok = false;
+                    break;
+                }
+                if (slot.segments.empty()) break;
+                segment = std::move(slot.segments.front());
+                slot.segments.pop_front();
+            }
+
+            if (!segment.data.empty()) {
+                out.write(segment.data.data(), static_cast<std::streamsize>(segment.data.size()));
+                std::lock_guard<std::mutex> lock(mutex);
+                held -= segment.data.size();
+                continue;
+            }
+
+            // Replay a spilled chunk
+            // 退避したチャンクを再生
+            read_buffer.resize(segment.length);
+            if (ok && !readAll(spill_fd, read_buffer.data(), segment.length, segment.offset)) {
+                std::cerr << "Error: Cannot read reorder spill file for task " << task << "\n";
+                out.setstate(std::ios::badbit);
+                ok = false;
+            }
+            if (ok) {
+                out.write(read_buffer.data(), static_cast<std::streamsize>(segment.length));
+            }
+        }
+        return ok;
+    }
+
+    // Total bytes written to the spill file / 退避ファイルに書き込んだ合計バイト数
+    long long spilledBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return spilled;
+    }
+
+    // Peak bytes of pending output held in memory / メモリに保持した未書き込み出力のピークバイト数
+    size_t peakMemory() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return peak;
+    }
+
+private:
+    // A chunk held in memory (data non-empty) or in the spill file
+    // メモリ上（data が空でない）または退避ファイル上のチャンク
+    struct Segment {
+        std::string data;
+        off_t offset = 0;
+        size_t length = 0;
+    };
+
+    struct Slot {
+        std::deque<Segment> segments;  // Chunks not yet written / 未書き込みのチャンク
+        bool done = false;             // Whether the task has finished / タスクが完了したか
+    };
+
+    std::vector<Slot> slots;
+    size_t memory_cap;
+    std::string spill_dir;
+
+    mutable std::mutex mutex;
+    std::condition_variable ready;
+    size_t held = 0;
+    size_t peak = 0;
+    long long spilled = 0;
+    int spill_fd = -1;       // Shared spill file (-1 = none yet) / 共有の退避ファイル（-1 = まだない）
+    off_t spill_size = 0;    // Bytes reserved in the spill file / 退避ファイル内の確保済みバイト数
+    bool spill_failed = false;
+
+    // Called with the lock held / ロックを保持した状態で呼ばれる
+    void pushMemory(Slot& slot, std::string&& chunk) {
+        held += chunk.size();
+        peak = std::max(peak, held);
+        slot.segments.push_back({std::move(chunk), 0, 0});
+        ready.notify_all();
+    }
+
+    // Called with the lock held; wakes the writing thread so that it fails
+    // ロックを保持した状態で呼ばれる。書き込みスレッドを起こして失敗させる
+    void reportSpillFailure() {
+        if (!spill_failed) {
+            std::cerr << "Error: Cannot write reorder spill file in " << spill_dir << "\n";
+        }
+        spill_failed = true;
+        ready.notify_all();
+    }
+
+    // Creates an unlinked temporary file; returns its descriptor or -1
+    // unlink 済みの一時ファイルを作成し、そのディスクリプタまたは -1 を返す
+    int createSpillFile() const {
+        std::string path = spill_dir + "/rotunfold-spill-XXXXXX";
+        int fd = ::mkstemp(&path[0]);
+        if (fd >= 0) ::unlink(path.c_str());
+        return fd;
+    }
+
+    static bool writeAll(int fd, const char* data, size_t size, off_t offset) {
+        while (size > 0) {
+            ssize_t n = ::pwrite(fd, data, size, offset);
+            if (n <= 0) return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += n;
+        }
+        return true;
+    }
+
+    static bool readAll(int fd, char* data, size_t size, off_t offset) {
+        while (size > 0) {
+            ssize_t n = ::pread(fd, data, size, offset);
+            if (n <= 0) return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += n;
+        }
+        return true;
+    }
+};
+
+// ============================================================================
+// ReorderStreamBuf
+// ============================================================================
+//
+// Output stream buffer of one task: collects the output into chunks of
+// ReorderBuffer::CHUNK_SIZE bytes and appends each full chunk to the
+// ReorderBuffer, so that a long-running task never holds its whole output.
+// 1つのタスクの出力ストリームバッファ: 出力を ReorderBuffer::CHUNK_SIZE バイトの
+// チャンクにまとめ、満杯になったチャンクを ReorderBuffer に追加する。これにより、
+// 長時間実行されるタスクが出力全体を保持することはない。
+//
+// ============================================================================
+class ReorderStreamBuf : public std::streambuf {
+public:
+    ReorderStreamBuf(ReorderBuffer& buffer, int task)
+        : buffer(buffer), task(task) {
+        resetChunk();
+    }
+
+    ReorderStreamBuf(const ReorderStreamBuf&) = delete;
+    ReorderStreamBuf& operator=(const ReorderStreamBuf&) = delete;
+
+    // ------------------------------------------------------------------------
+    // finish
+    // ------------------------------------------------------------------------
+    //
+    // Appends the last (partial) chunk and marks the task as complete.
+    // 最後の（部分的な）チャンクを追加し、タスクを完了済みにする。
+    //
+    // ------------------------------------------------------------------------
+    void finish() {
+        chunk.resize(static_cast<size_t>(pptr() - pbase()));
+        chunk.shrink_to_fit();
+        buffer.append(task, std::move(chunk));
+        buffer.finish(task);
+        chunk.clear();
+        setp(nullptr, nullptr);
+    }
+
+protected:
+    int overflow(int c) override {
+        if (pbase() == nullptr) return traits_type::eof();
+        buffer.append(task, std::move(chunk));
+        resetChunk();
+        if (c != traits_type::eof()) {
+            *pptr() = static_cast<char>(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    // Flushing does not hand over partial chunks; the writing thread only
+    // needs complete chunks and the final one
+    // フラッシュでは部分的なチャンクを受け渡さない。書き込みスレッドに必要なのは
+    // 満杯のチャンクと最後のチャンクのみ
+    int sync() override {
+        return 0;
+    }
+
+private:
+    ReorderBuffer& buffer;
+    int task;
+    std::string chunk;
+
+    void resetChunk() {
+        chunk = std::string(ReorderBuffer::CHUNK_SIZE, '\0');
+        setp(&chunk[0], &chunk[0] + chunk.size());
+    }
+};
+
+#endif  // REORG_REORDER_BUFFER_HPP
@@ -49,7 +49,12 @@
 #include "UnfoldedFace.hpp"
 #include "Polyhedron.hpp"
 #include "GeometryUtil.hpp"
+#include "Placement.hpp"
 #include "JsonUtil.hpp"
+#include "BinaryRecord.hpp"
+#include "SearchOptions.hpp"
+#include "TopK.hpp"
+#include <algorithm>
 #include <vector>
 #include <iostream>
 #include <cmath>
@@ -124,6 +129,8 @@ public:
     //   enable_symmetry   : Whether to enable y-axis symmetry-based pruning
     //   y_moved_off_axis  : Whether no face center has yet moved away from y=0
     //                       (used for symmetry pruning; usually same as enable_symmetry)
+    //   options           : Emit tolerance and output tagging options
+    //                       (defaults reproduce the standard Phase 1 output)
     //
     // 入力:
     //   poly              : 多面体構造への参照（不変）
@@ -132,6 +139,8 @@ public:
     //   enable_symmetry   : y軸対称性に基づく枝刈りを有効にするか
     //   y_moved_off_axis  : 面の中心がまだy=0以外の値に移動していないか
     //                       （対称性枝刈りの判定に使用。通常は enable_symmetry と同じ）
+    //   options           : 出力許容値と出力タグ付けのオプション
+    //                       （既定値は標準の Phase 1 出力を再現する）
     //
     // Guarantee:
     //   - Initializes the search state
@@ -149,13 +158,16 @@ public:
         int base_face,
         int base_edge,
         bool enable_symmetry,
-        bool y_moved_off_axis
+        bool y_moved_off_axis,
+        const SearchOptions& options = SearchOptions()
     )
         : polyhedron(poly),
         base_face_id(base_face),
         base_edge_id(base_edge),
         symmetry_enabled(enable_symmetry),
-        y_moved_off_axis(y_moved_off_axis) {}
+        y_moved_off_axis(y_moved_off_axis),
+        options(options),
+        prune_buffer(std::max(GeometryUtil::buffer, options.emit_buffer)) {}
 
     // ------------------------------------------------------------------------
     // runRotationalUnfolding
@@ -164,10 +176,18 @@ public:
     // Input:
     //   jsonl_output : Output stream for JSONL records
     //                  (one line per candidate path-shaped partial unfolding)
+    //   first_branch : Index of the branch from the second face to explore
+    //                  (0 .. numFirstBranches() - 1), or -1 to explore all
+    //   top_k        : Collector for the top-K mode, or nullptr to write every
+    //                  candidate to jsonl_output
     //
     // 入力:
     //   jsonl_output : JSONLレコード用の出力ストリーム
     //                  （候補となるパス状の部分展開図ごとに1行）
+    //   first_branch : 2番目の面から探索する枝の番号
+    //                  （0 .. numFirstBranches() - 1）。-1 の場合はすべて探索
+    //   top_k        : top-K モードのコレクタ。nullptr の場合はすべての候補を
+    //                  jsonl_output に書き込む
     //
     // Output:
     //   Writes all candidates found during the search as JSONL records
@@ -184,6 +204,15 @@ public:
     //   - Reduces the search space by distance-based and symmetry-based pruning
     //   - Does not modify the polyhedron structure
     //   - May write zero or more JSONL records depending on the polyhedron
+    //   - Concatenating the outputs for first_branch = 0, 1, ...,
+    //     numFirstBranches() - 1 yields exactly the output for first_branch = -1
+    //     (the record for the second face itself belongs to branch 0)
+    //   - With top_k, candidates are offered to the collector instead of being
+    //     written, and branches that cannot beat its threshold are pruned
+    //   - With SearchOptions::binary_records, records are written in the
+    //     binary form (see BinaryRecord.hpp) instead of JSONL
+    //   - Once SearchOptions::stop is set, returns without visiting further
+    //     nodes (the output is then incomplete)
     //
     // 保証:
     //   - 基準面・基準辺から始まる、構成可能なすべてのパスを探索する
@@ -191,9 +220,24 @@ public:
     //   - 距離および対称性に基づく枝刈りで探索空間を削減する
     //   - 多面体構造を変更しない
     //   - 多面体に応じて0個以上のJSONLレコードを書き込む
+    //   - first_branch = 0, 1, ..., numFirstBranches() - 1 の出力を連結すると、
+    //     first_branch = -1 の出力と完全に一致する
+    //     （2番目の面自体のレコードは枝 0 に属する）
+    //   - top_k を指定した場合、候補は書き込まれる代わりにコレクタに渡され、
+    //     その閾値を上回れない枝は刈り込まれる
+    //   - SearchOptions::binary_records の場合、レコードは JSONL の代わりに
+    //     バイナリ形式（BinaryRecord.hpp を参照）で書き込まれる
+    //   - SearchOptions::stop が設定されると、それ以上ノードを訪問せずに戻る
+    //     （その場合、出力は不完全になる）
     //
     // ------------------------------------------------------------------------
-    void runRotationalUnfolding(std::ostream& jsonl_output) {
+    void runRotationalUnfolding(std::ostream& jsonl_output, int first_branch = -1,
+                                TopKCollector* top_k = nullptr) {
+
+        selected_first_branch = first_branch;
+        top_k_collector = top_k;
+        node_count = 0;
+        node_limit_reached = false;
 
         // Initialize array tracking whether each face is used in the path (true = unused, false = used)
         // 各面がパスに使用済みかどうかを管理する配列を初期化（true = 未使用、false = 使用済み）
@@ -224,6 +268,40 @@ public:
         searchPartialUnfoldings(second_face_state, face_usage, jsonl_output);
     }
 
+    // ------------------------------------------------------------------------
+    // numFirstBranches
+    // ------------------------------------------------------------------------
+    //
+    // Returns the number of branches explored from the second face
+    // (i.e., the gon of the second face minus one). Used to split the search
+    // from one root pair into independent tasks.
+    //
+    // 2番目の面から探索される枝の数（2番目の面の角数 - 1）を返す。
+    // 1つの root pair からの探索を独立したタスクに分割するために使用する。
+    //
+    // ------------------------------------------------------------------------
+    int numFirstBranches() const {
+        int base_edge_pos = polyhedron.getEdgeIndex(base_face_id, base_edge_id);
+        int second_face_id = polyhedron.adj_faces[base_face_id][base_edge_pos];
+        return polyhedron.gon_list[second_face_id] - 1;
+    }
+
+    // ------------------------------------------------------------------------
+    // nodeCount / nodeLimitReached
+    // ------------------------------------------------------------------------
+    //
+    // Number of search nodes (calls of searchPartialUnfoldings) visited by the
+    // last runRotationalUnfolding, and whether SearchOptions::node_limit cut
+    // the search short.
+    //
+    // 直前の runRotationalUnfolding で訪問した探索ノード数
+    // （searchPartialUnfoldings の呼び出し回数）と、
+    // SearchOptions::node_limit により探索が打ち切られたかどうか。
+    //
+    // ------------------------------------------------------------------------
+    long long nodeCount() const { return node_count; }
+    bool nodeLimitReached() const { return node_limit_reached; }
+
 private:
     // ------------------------------------------------------------------------
     // Private member variables
@@ -251,6 +329,29 @@ private:
     // （対称性枝刈りの判定に使用。通常は enable_symmetry と同じ）
     bool y_moved_off_axis;
 
+    // Emit tolerance and output tagging options
+    // 出力許容値と出力タグ付けのオプション
+    SearchOptions options;
+
+    // Tolerance used by distance-based pruning
+    // (never tighter than the emit tolerance, so no emittable candidate is pruned)
+    // 距離に基づく枝刈りに使用する許容値
+    // （出力許容値より厳しくしないことで、出力対象の候補を枝刈りしない）
+    double prune_buffer;
+
+    // Branch from the second face selected by runRotationalUnfolding (-1 = all)
+    // runRotationalUnfolding で選択された2番目の面からの枝（-1 = すべて）
+    int selected_first_branch = -1;
+
+    // Collector of the top-K mode (nullptr = write every candidate)
+    // top-K モードのコレクタ（nullptr = すべての候補を書き込む）
+    TopKCollector* top_k_collector = nullptr;
+
+    // Number of search nodes visited, and whether the node limit was reached
+    // 訪問した探索ノード数と、ノード数上限に達したかどうか
+    long long node_count = 0;
+    bool node_limit_reached = false;
+
     // Sequence of unfolded faces constituting the current path-shaped partial unfolding
     // 現在探索中のパス状の部分展開図を構成する展開済みの面の列
     std::vector<UnfoldedFace> partial_unfolding;
@@ -297,28 +398,14 @@ private:
         int second_face_id = polyhedron.adj_faces[base_face_id][base_edge_pos];
         int second_edge_id = polyhedron.adj_edges[base_face_id][base_edge_pos];
 
-        double base_face_inradius = GeometryUtil::inradius(polyhedron.gon_list[base_face_id]);
-        double second_face_inradius = GeometryUtil::inradius(polyhedron.gon_list[second_face_id]);
-
-        // Place the base edge perpendicular to the positive x-axis.
-        // For a convex regular-faced polyhedron, the second face's center has y = 0,
-        // and its x-coordinate is the sum of the inradii of the base and second faces.
-        //
-        // 基準辺をx軸正の方向に垂直に配置する。
-        // 整面凸多面体の場合、2番目の面の中心はy = 0であり、
-        // そのx座標は基準面と2番目の面の内接円半径の合計となる。
-        double second_face_x = base_face_inradius + second_face_inradius;
-        double second_face_y = 0.0;
-
-        // The vector from the center of the second face to the center of the base face
-        // points in the negative x-direction, and the base edge is perpendicular to this vector.
-        // Since angles are measured from the positive x-axis in the range [-180°, 180°],
-        // the initial angle is set to -180°.
-        //
-        // 2番目の面の中心から基準面の中心へ向かうベクトルの方向はx軸負方向であり、
-        // 基準辺はこのベクトルに直交する。
-        // 角度はx軸正方向を0°とし -180°以上180°以下で表すため、初期角度は -180° とする。
-        double second_face_angle = -180.0;
+        // Place the base edge perpendicular to the positive x-axis, so that the
+        // second face's center lies on the positive x-axis (see Placement)
+        // 基準辺をx軸正の方向に垂直に配置し、2番目の面の中心をx軸正方向上に置く
+        // （Placement を参照）
+        double second_face_x, second_face_y, second_face_angle;
+        Placement::placeSecondFace(polyhedron.gon_list[base_face_id],
+                                   polyhedron.gon_list[second_face_id],
+                                   second_face_x, second_face_y, second_face_angle);
 
         return {
             second_face_id,
@@ -396,9 +483,27 @@ private:
                                  std::vector<bool>& face_usage,
                                  std::ostream& jsonl_output) {
 
+        // Count this node, and stop once the probe limit is exhausted
+        // このノードを数え、プローブの上限に達したら打ち切る
+        ++node_count;
+        if (options.node_limit > 0 && node_count > options.node_limit) {
+            node_limit_reached = true;
+            return;
+        }
+
+        // Stop once the output can no longer be delivered
+        // 出力をもう届けられなければ打ち切る
+        if (options.stop != nullptr && options.stop->load(std::memory_order_relaxed)) {
+            return;
+        }
+
         int current_face_id = state.face_id;
         int current_face_gon = polyhedron.gon_list[current_face_id];
 
+        // Whether this is the second face and only one of its branches is explored
+        // 2番目の面であり、その枝のうち1つのみを探索するかどうか
+        bool split_here = selected_first_branch >= 0 && partial_unfolding.size() == 1;
+
         // Mark the current face as used
         // 現在の面を使用済みにマーク
         face_usage[current_face_id] = false;
@@ -422,20 +527,31 @@ private:
 
         // Round very small values to zero to avoid floating-point noise
         // 浮動小数点ノイズを避けるために、非常に小さい値を0に丸める
-        if (std::fabs(state.x) < 1e-10) state.x = 0.0;
-        if (std::fabs(state.y) < 1e-10) state.y = 0.0;
+        Placement::suppressNoise(state.x);
+        Placement::suppressNoise(state.y);
 
         double distance_from_origin = GeometryUtil::getDistanceFromOrigin(state.x, state.y);
 
         double base_face_circumradius = GeometryUtil::circumradius(polyhedron.gon_list[base_face_id]);
         double current_face_circumradius = GeometryUtil::circumradius(current_face_gon);
 
+        // In the top-K mode, the tolerance is tightened to the K-th best circle gap:
+        // distance - remaining - (both circumradii) is a lower bound of the circle gap
+        // of every candidate below this node, including this one
+        // top-K モードでは、許容値を K 番目に良い円ギャップまで厳しくする:
+        // 距離 - 残距離 - (両外接円半径) は、このノード以下のすべての候補
+        // （このノード自身を含む）の円ギャップの下界である
+        double prune_limit = prune_buffer;
+        if (top_k_collector != nullptr) {
+            prune_limit = std::min(prune_limit, top_k_collector->threshold());
+        }
+
         // Pruning: If the remaining unused faces cannot reach the base face, prune this branch
         // 枝刈り: 残りの未使用面が基準面に到達できない場合、この枝を刈り込む
         if (distance_from_origin > state.remaining_distance
                                  + base_face_circumradius
                                  + current_face_circumradius
-                                 + GeometryUtil::buffer) {
+                                 + prune_limit) {
             backtrackCurrentFace(current_face_id, face_usage);
             return;
         }
@@ -461,14 +577,36 @@ private:
         // この部分展開図を候補として出力
         if (distance_from_origin < base_face_circumradius
                                  + current_face_circumradius
-                                 + GeometryUtil::buffer) {
-            JsonUtil::writeJsonlRecord(
-                jsonl_output,
-                base_face_id,
-                base_edge_id,
-                symmetry_enabled,
-                partial_unfolding
-            );
+                                 + options.emit_buffer
+            && (!split_here || selected_first_branch == 0)) {
+            // Endpoint slack: how far the circumcircles are from touching
+            // (negative when they intersect)
+            // 端点スラック: 外接円どうしが接するまでの距離（交差時は負）
+            EndpointSlack slack = {
+                distance_from_origin - base_face_circumradius - current_face_circumradius
+            };
+
+            if (top_k_collector != nullptr) {
+                top_k_collector->offer(slack.circle_gap, partial_unfolding);
+            } else if (options.binary_records) {
+                BinaryRecord::writeRecord(
+                    jsonl_output,
+                    base_face_id,
+                    base_edge_id,
+                    symmetry_enabled,
+                    partial_unfolding,
+                    options.tag_slack ? &slack : nullptr
+                );
+            } else {
+                JsonUtil::writeJsonlRecord(
+                    jsonl_output,
+                    base_face_id,
+                    base_edge_id,
+                    symmetry_enabled,
+                    partial_unfolding,
+                    options.tag_slack ? &slack : nullptr
+                );
+            }
         }
 
         // Get the index of the current edge to determine the starting position
@@ -483,8 +621,11 @@ private:
         for (int i = current_edge_pos + 1; i < current_edge_pos + current_face_gon; ++i) {
             // Incrementally adjust the rotation angle for each adjacent face
             // 各隣接面について回転角度を段階的に調整
-            next_face_angle -= 360.0 / static_cast<double>(current_face_gon);
-            GeometryUtil::normalizeAngle(next_face_angle);
+            Placement::advanceEdge(next_face_angle, current_face_gon);
+
+            // When split, explore only the selected branch of the second face
+            // 分割時は、2番目の面の選択された枝のみを探索する
+            if (split_here && i - current_edge_pos - 1 != selected_first_branch) continue;
 
             int next_face_id = polyhedron.adj_faces[current_face_id][i % current_face_gon];
 
@@ -495,20 +636,14 @@ private:
             int next_edge_id = polyhedron.adj_edges[current_face_id][i % current_face_gon];
 
             // The distance between the centers of the current and next faces
-            // is the sum of their inradii. Since the angle is already computed,
-            // use trigonometry to calculate the next face's position.
+            // is the sum of their inradii, along the direction already computed.
             //
-            // 現在の面と次の面の中心間の距離は、両面の内接円半径の合計である。
-            // 角度はすでに計算されているので、三角関数を使用して次の面の位置を計算する。
-            double current_inradius = GeometryUtil::inradius(current_face_gon);
-            double next_inradius = GeometryUtil::inradius(polyhedron.gon_list[next_face_id]);
-
-            double next_face_x = state.x
-                               + (current_inradius + next_inradius)
-                               * std::cos(next_face_angle * GeometryUtil::PI / 180.0);
-            double next_face_y = state.y
-                               + (current_inradius + next_inradius)
-                               * std::sin(next_face_angle * GeometryUtil::PI / 180.0);
+            // 現在の面と次の面の中心間の距離は、すでに計算した方向に沿った
+            // 両面の内接円半径の合計である。
+            double next_face_x, next_face_y;
+            Placement::placeAdjacentFace(state.x, state.y, next_face_angle,
+                                         current_face_gon, polyhedron.gon_list[next_face_id],
+                                         next_face_x, next_face_y);
 
             FaceState next_state = {
                 next_face_id,
@@ -0,0 +1,151 @@
+// ============================================================================
+// SearchOptions.hpp
+// ============================================================================
+//
+// What this file does:
+//   Defines the options that control how the rotational unfolding search
+//   decides which candidates to emit and what to attach to each record.
+//
+// このファイルの役割:
+//   回転展開探索がどの候補を出力するか、および各レコードに何を付加するかを
+//   制御するオプションを定義する。
+//
+// Responsibility in the project:
+//   - Stores the emit tolerance used by overlap detection
+//   - Stores output tagging flags (e.g., endpoint slack)
+//   - Stores the node limit used by cost probes
+//   - Stores the flag that stops the search early
+//   - Does NOT parse CLI arguments or perform the search
+//
+// プロジェクト内での責務:
+//   - 重なり検出に使用する出力許容値を保持
+//   - 出力タグ付けのフラグ（例: 端点スラック）を保持
+//   - コストプローブで使用するノード数上限を保持
+//   - 探索を早期に打ち切るフラグを保持
+//   - CLI引数の解析や探索そのものは担当しない
+//
+// Phase 1 における位置づけ:
+//   Configuration passed from the CLI to RotationalUnfolding.
+//   The defaults reproduce the standard Phase 1 output exactly.
+//   Phase 1では、CLI から RotationalUnfolding へ渡される設定。
+//   既定値は標準の Phase 1 出力をそのまま再現する。
+//
+// ============================================================================
+
+#ifndef REORG_SEARCH_OPTIONS_HPP
+#define REORG_SEARCH_OPTIONS_HPP
+
+#include "GeometryUtil.hpp"
+#include <atomic>
+
+// ============================================================================
+// SearchOptions
+// ============================================================================
+//
+// Options for a single rotational unfolding search.
+// 1回の回転展開探索に対するオプション。
+//
+// Responsibility:
+//   - Holds the tolerance added to the circumradius sum in overlap detection
+//   - Holds whether each record is tagged with its endpoint slack
+//   - Holds whether records are written as JSONL or binary
+//
+// 責務:
+//   - 重なり検出で外接円半径の和に加える許容値を保持
+//   - 各レコードに端点スラックを付加するかを保持
+//   - レコードを JSONL とバイナリのどちらで書き込むかを保持
+//
+// Does NOT handle:
+//   - Validation of option values (done by the CLI)
+//
+// 責務外:
+//   - オプション値の検証（CLI で実施）
+//
+// ============================================================================
+struct SearchOptions {
+    // ------------------------------------------------------------------------
+    // Tolerance added to the sum of the circumradii of the base face and the
+    // last face when deciding whether to emit a candidate.
+    // A value larger than GeometryUtil::buffer also widens distance-based
+    // pruning so that no candidate within this tolerance is pruned.
+    //
+    // 候補を出力するか判定する際に、基準面と最終面の外接円半径の和に加える許容値。
+    // GeometryUtil::buffer より大きい値の場合、この許容値内の候補が枝刈りされない
+    // よう、距離に基づく枝刈りの基準も同じだけ緩める。
+    // ------------------------------------------------------------------------
+    double emit_buffer = GeometryUtil::buffer;
+
+    // ------------------------------------------------------------------------
+    // Whether to append the endpoint slack (see EndpointSlack) to each record.
+    // 各レコードに端点スラック（EndpointSlack を参照）を付加するか。
+    // ------------------------------------------------------------------------
+    bool tag_slack = false;
+
+    // ------------------------------------------------------------------------
+    // Whether to write records in the binary form (see BinaryRecord.hpp)
+    // instead of JSONL. Used by the shared-memory handoff.
+    // レコードを JSONL の代わりにバイナリ形式（BinaryRecord.hpp を参照）で
+    // 書き込むか。共有メモリによる受け渡しで使用する。
+    // ------------------------------------------------------------------------
+    bool binary_records = false;
+
+    // ------------------------------------------------------------------------
+    // Maximum number of search nodes to visit (0 = unlimited).
+    // Used to probe the cost of a root pair without running it to completion;
+    // a limited search writes an incomplete output and must not be used as
+    // a result.
+    //
+    // 訪問する探索ノード数の上限（0 = 無制限）。
+    // root pair を最後まで実行せずにコストを見積もるために使用する。
+    // 上限付きの探索は不完全な出力を書き込むため、結果として使用してはならない。
+    // ------------------------------------------------------------------------
+    long long node_limit = 0;
+
+    // ------------------------------------------------------------------------
+    // Flag that ends the search early once set (nullptr = never stopped).
+    // Set by the owner of the output when the records can no longer be
+    // delivered (e.g., the consumer of the shared-memory ring stopped
+    // reading); a stopped search writes an incomplete output and must not be
+    // used as a result.
+    //
+    // 設定されると探索を早期に打ち切るフラグ（nullptr = 打ち切らない）。
+    // レコードをもう届けられなくなったとき（例: 共有メモリのリングの読み手が
+    // 読み取りをやめた）に出力の所有者が設定する。打ち切られた探索は不完全な
+    // 出力を書き込むため、結果として使用してはならない。
+    // ------------------------------------------------------------------------
+    std::atomic<bool>* stop = nullptr;
+};
+
+// ============================================================================
+// EndpointSlack
+// ============================================================================
+//
+// Describes how close the last face of a path is to overlapping the base face.
+// パスの最終面が基準面とどれだけ重なりに近いかを表す。
+//
+// Responsibility:
+//   - Stores the circle gap: distance between the two face centers minus
+//     the sum of their circumradii (negative = circumcircles intersect)
+//
+// 責務:
+//   - 円ギャップを保持: 2面の中心間距離から外接円半径の和を引いた値
+//     （負 = 外接円が交差している）
+//
+// A record emitted under tolerance t satisfies circle_gap < t, so filtering
+// records by circle_gap < t' reproduces the output for any tighter t' <= t
+// (up to the 6-decimal rounding of the written value).
+// 許容値 t で出力されたレコードは circle_gap < t を満たすため、
+// circle_gap < t' で絞り込めば、より厳しい任意の t' <= t の出力を再現できる
+// （書き出される値の小数点以下6桁の丸めの範囲で）。
+//
+// ============================================================================
+struct EndpointSlack {
+    // ------------------------------------------------------------------------
+    // Center distance minus the sum of the circumradii of the base face and
+    // the last face.
+    // 基準面と最終面の中心間距離から外接円半径の和を引いた値。
+    // ------------------------------------------------------------------------
+    double circle_gap;
+};
+
+#endif  // REORG_SEARCH_OPTIONS_HPP
@@ -0,0 +1,652 @@
+// ============================================================================
+// ShmRing.hpp
+// ============================================================================
+//
+// What this file does:
+//   Implements a single-producer, single-consumer ring buffer of binary
+//   records in a memfd shared between rotunfold and a consumer process, with
+//   eventfd wakeups.
+//
+// このファイルの役割:
+//   rotunfold と読み手のプロセスが共有する memfd 上に、バイナリレコードの
+//   単一生産者・単一消費者リングバッファを実装する。起床には eventfd を使う。
+//
+// Responsibility in the project:
+//   - Creates the ring (consumer side) and attaches to it (producer side)
+//   - Maps the data area twice back to back, so every record is contiguous
+//     in memory even where it wraps around the end of the ring
+//   - Producer: an output stream buffer whose put area is the free space of
+//     the ring itself (records are formatted directly into shared memory),
+//     and a watcher that stops the search once the consumer stops reading
+//   - Consumer: hands out records in place, without copying
+//   - Does NOT define the record layout (see BinaryRecord.hpp)
+//
+// プロジェクト内での責務:
+//   - リングの作成（読み手側）と接続（生産者側）
+//   - データ領域を2回連続してマップし、リング末尾で折り返すレコードもメモリ上で
+//     連続させる
+//   - 生産者: 書き込み領域がリングの空き領域そのものである出力ストリームバッファ
+//     （レコードは共有メモリ上に直接書式化される）と、読み手が読み取りを
+//     やめた時点で探索を止める監視
+//   - 読み手: レコードをコピーせずにその場で渡す
+//   - レコードのレイアウトは定義しない（BinaryRecord.hpp を参照）
+//
+// Phase 1 における位置づけ:
+//   Fast path of `rotunfold --shm-ring` for pipelines fused on one machine:
+//   records reach the consumer in raw.jsonl order without JSON formatting,
+//   pipe copies, or parsing. The Python reader is
+//   python/rotational_unfolding/shm_ring.py.
+//   Phase 1では、1台のマシン上で結合したパイプライン向けの
+//   `rotunfold --shm-ring` の高速経路。レコードは JSON の書式化、パイプのコピー、
+//   解析なしに raw.jsonl の順で読み手に届く。Python の読み手は
+//   python/rotational_unfolding/shm_ring.py。
+//
+// Protocol:
+//   - The consumer creates the ring (one memfd and two eventfds, "data" and
+//     "space") and starts rotunfold with the descriptors inherited, passing
+//     --shm-ring MEMFD,DATAFD,SPACEFD
+//   - write_pos and read_pos count bytes since the start and only grow; the
+//     byte at position p is at data offset p % capacity. The producer
+//     publishes write_pos at least every WINDOW bytes and on every flush
+//     (after each root pair); the consumer publishes read_pos at least every
+//     capacity / 8 bytes and before it waits
+//   - A side that finds nothing to do sets its *_waiting flag, re-checks,
+//     and waits on its eventfd; the other side signals the eventfd after
+//     publishing if the flag is set. Waits also time out after 50 ms, so a
+//     missed signal only costs latency
+//   - The producer ends by setting producer_state (1 = complete, 2 = failed);
+//     a consumer that stops early sets consumer_closed, and the producer
+//     then stops its search and fails instead of waiting for space
+//   - Records must be smaller than the capacity
+//
+// プロトコル:
+//   - 読み手がリング（memfd 1つと eventfd 2つ、"data" と "space"）を作成し、
+//     記述子を継承させて --shm-ring MEMFD,DATAFD,SPACEFD で rotunfold を起動する
+//   - write_pos と read_pos は先頭からのバイト数で、増加のみする。位置 p の
+//     バイトはデータ領域のオフセット p % capacity にある。生産者は少なくとも
+//     WINDOW バイトごと、およびフラッシュごと（各 root pair の後）に write_pos を
+//     公開し、読み手は少なくとも capacity / 8 バイトごと、および待機の前に
+//     read_pos を公開する
+//   - することのない側は *_waiting フラグを立てて再確認し、自分の eventfd で
+//     待機する。もう一方の側は公開後、フラグが立っていれば eventfd に通知する。
+//     待機は 50 ms でもタイムアウトするため、通知を取り逃しても遅延が増えるだけ
+//   - 生産者は producer_state（1 = 完了、2 = 失敗）を設定して終了する。途中で
+//     やめる読み手は consumer_closed を設定し、生産者は探索を止め、空きを待たずに
+//     失敗する
+//   - レコードは容量より小さくなければならない
+//
+// Shared layout (offsets in bytes; the data area starts at data_offset,
+// which is the page size):
+//   0   char[8] magic "RUFRING1"    64  uint64 write_pos    192 uint32 producer_state
+//   8   uint32  version (1)         128 uint64 read_pos     196 uint32 consumer_closed
+//   12  uint32  data_offset                                 256 uint32 consumer_waiting
+//   16  uint64  capacity                                    320 uint32 producer_waiting
+//
+// ============================================================================
+
+#ifndef REORG_SHM_RING_HPP
+#define REORG_SHM_RING_HPP
+
+#include "BinaryRecord.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ============================================================================
+// ShmRingHeader
+// ============================================================================
+//
+// Control block at the start of the memfd. Fields written by one side are
+// on their own cache line.
+// memfd の先頭にある制御ブロック。一方の側が書き込むフィールドは個別の
+// キャッシュラインに置く。
+//
+// ============================================================================
+struct ShmRingHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t data_offset;
+    std::uint64_t capacity;
+    alignas(64) std::atomic<std::uint64_t> write_pos;
+    alignas(64) std::atomic<std::uint64_t> read_pos;
+    alignas(64) std::atomic<std::uint32_t> producer_state;
+    std::atomic<std::uint32_t> consumer_closed;
+    alignas(64) std::atomic<std::uint32_t> consumer_waiting;
+    alignas(64) std::atomic<std::uint32_t> producer_waiting;
+};
+
+static_assert(offsetof(ShmRingHeader, write_pos) == 64, "ShmRingHeader layout is shared with Python");
+static_assert(offsetof(ShmRingHeader, read_pos) == 128, "ShmRingHeader layout is shared with Python");
+static_assert(offsetof(ShmRingHeader, producer_state) == 192, "ShmRingHeader layout is shared with Python");
+static_assert(offsetof(ShmRingHeader, consumer_closed) == 196, "ShmRingHeader layout is shared with Python");
+static_assert(offsetof(ShmRingHeader, consumer_waiting) == 256, "ShmRingHeader layout is shared with Python");
+static_assert(offsetof(ShmRingHeader, producer_waiting) == 320, "ShmRingHeader layout is shared with Python");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Ring positions must be lock-free across processes");
+
+// ============================================================================
+// ShmRing
+// ============================================================================
+//
+// The mapping of a ring and its descriptors (owned; closed on destruction).
+// リングのマッピングとその記述子（所有し、破棄時に閉じる）。
+//
+// ============================================================================
+class ShmRing {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = size_t(64) << 20;  // 64 MiB
+    static constexpr size_t MIN_CAPACITY = size_t(1) << 20;       // 1 MiB
+    static constexpr std::uint32_t PRODUCER_RUNNING = 0;
+    static constexpr std::uint32_t PRODUCER_COMPLETE = 1;
+    static constexpr std::uint32_t PRODUCER_FAILED = 2;
+    static constexpr int WAIT_MS = 50;  // Longest wait on an eventfd / eventfd での最長の待機時間
+
+    ShmRing() = default;
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    ~ShmRing() {
+        if (data_area != nullptr) munmap(data_area, 2 * ring_capacity);
+        if (control != nullptr) munmap(control, control_size);
+        for (int fd : {mem_fd, data_fd, space_fd}) {
+            if (fd >= 0) ::close(fd);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // create
+    // ------------------------------------------------------------------------
+    //
+    // Creates a new ring (consumer side) of at least capacity bytes (rounded
+    // up to whole pages, at least MIN_CAPACITY). The descriptors are
+    // inheritable, for passing to rotunfold (see fdArgument).
+    // Returns false on failure (with an error on std::cerr).
+    // 少なくとも capacity バイト（ページ単位に切り上げ、MIN_CAPACITY 以上）の
+    // 新しいリングを作成する（読み手側）。記述子は rotunfold に渡すため継承可能
+    // （fdArgument を参照）。失敗時は false を返す（std::cerr にエラーを出力）。
+    //
+    // ------------------------------------------------------------------------
+    bool create(size_t capacity) {
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        capacity = std::max(capacity, MIN_CAPACITY);
+        capacity = (capacity + page - 1) / page * page;
+
+        mem_fd = memfd_create("rotunfold-ring", 0);
+        data_fd = eventfd(0, EFD_NONBLOCK);
+        space_fd = eventfd(0, EFD_NONBLOCK);
+        if (mem_fd < 0 || data_fd < 0 || space_fd < 0
+            || ftruncate(mem_fd, static_cast<off_t>(page + capacity)) != 0) {
+            std::cerr << "Error: Cannot create shared-memory ring: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        if (!mapControl(page)) return false;
+
+        std::memcpy(control->magic, MAGIC, sizeof(control->magic));
+        control->version = VERSION;
+        control->data_offset = static_cast<std::uint32_t>(page);
+        control->capacity = capacity;
+        return mapData();
+    }
+
+    // ------------------------------------------------------------------------
+    // attach
+    // ------------------------------------------------------------------------
+    //
+    // Attaches to a ring created by another process (producer side), given
+    // the descriptor list "MEMFD,DATAFD,SPACEFD". Returns false on failure
+    // (with an error on std::cerr).
+    // 他のプロセスが作成したリングに、記述子リスト "MEMFD,DATAFD,SPACEFD" を
+    // 与えて接続する（生産者側）。失敗時は false を返す（std::cerr にエラーを出力）。
+    //
+    // ------------------------------------------------------------------------
+    bool attach(const std::string& fds) {
+        char tail = 0;
+        if (std::sscanf(fds.c_str(), "%d,%d,%d%c", &mem_fd, &data_fd, &space_fd, &tail) != 3
+            || mem_fd < 0 || data_fd < 0 || space_fd < 0) {
+            mem_fd = data_fd = space_fd = -1;
+            std::cerr << "Error: --shm-ring must be MEMFD,DATAFD,SPACEFD\n";
+            return false;
+        }
+
+        struct stat st;
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        if (fstat(mem_fd, &st) != 0 || static_cast<size_t>(st.st_size) < page) {
+            std::cerr << "Error: Not a shared-memory ring: fd " << mem_fd << "\n";
+            return false;
+        }
+        if (!mapControl(page)) return false;
+        if (std::memcmp(control->magic, MAGIC, sizeof(control->magic)) != 0
+            || control->version != VERSION
+            || control->data_offset != page
+            || control->capacity % page != 0
+            || static_cast<std::uint64_t>(st.st_size) != control->data_offset + control->capacity) {
+            std::cerr << "Error: Not a shared-memory ring (or a different version): fd " << mem_fd << "\n";
+            return false;
+        }
+        return mapData();
+    }
+
+    // Descriptor list to pass as --shm-ring / --shm-ring に渡す記述子リスト
+    std::string fdArgument() const {
+        return std::to_string(mem_fd) + "," + std::to_string(data_fd) + "," + std::to_string(space_fd);
+    }
+
+    ShmRingHeader& header() const { return *control; }
+
+    // Data area, mapped twice: data()[i] == data()[i + capacity()]
+    // 2回マップしたデータ領域: data()[i] == data()[i + capacity()]
+    char* data() const { return data_area; }
+
+    size_t capacity() const { return ring_capacity; }
+
+    // Signals the "data" (producer -> consumer) or "space" (consumer ->
+    // producer) eventfd
+    // "data"（生産者 -> 読み手）または "space"（読み手 -> 生産者）の eventfd に通知する
+    void notifyData() const { notify(data_fd); }
+    void notifySpace() const { notify(space_fd); }
+
+    // Waits for a signal on the eventfd, at most WAIT_MS milliseconds
+    // eventfd への通知を最大 WAIT_MS ミリ秒待つ
+    void waitData() const { wait(data_fd); }
+    void waitSpace() const { wait(space_fd); }
+
+private:
+    static constexpr const char* MAGIC = "RUFRING1";
+    static constexpr std::uint32_t VERSION = 1;
+
+    int mem_fd = -1;
+    int data_fd = -1;
+    int space_fd = -1;
+    ShmRingHeader* control = nullptr;
+    size_t control_size = 0;
+    char* data_area = nullptr;
+    size_t ring_capacity = 0;
+
+    bool mapControl(size_t page) {
+        void* p = mmap(nullptr, page, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, 0);
+        if (p == MAP_FAILED) {
+            std::cerr << "Error: Cannot map shared-memory ring: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        control = static_cast<ShmRingHeader*>(p);
+        control_size = page;
+        return true;
+    }
+
+    // Reserves twice the capacity, then maps the data area into both halves
+    // 容量の2倍を予約し、データ領域を両半分にマップする
+    bool mapData() {
+        const size_t capacity = control->capacity;
+        void* base = mmap(nullptr, 2 * capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            std::cerr << "Error: Cannot map shared-memory ring: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        char* b = static_cast<char*>(base);
+        for (char* half : {b, b + capacity}) {
+            if (mmap(half, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                     mem_fd, control->data_offset) == MAP_FAILED) {
+                std::cerr << "Error: Cannot map shared-memory ring: " << std::strerror(errno) << "\n";
+                munmap(base, 2 * capacity);
+                return false;
+            }
+        }
+        data_area = b;
+        ring_capacity = capacity;
+        return true;
+    }
+
+    static void notify(int fd) {
+        std::uint64_t one = 1;
+        ssize_t written = ::write(fd, &one, sizeof(one));
+        (void)written;  // A full counter already wakes the reader / 満杯のカウンタはすでに起床させる
+    }
+
+    static void wait(int fd) {
+        pollfd p = {fd, POLLIN, 0};
+        if (poll(&p, 1, WAIT_MS) > 0) {
+            std::uint64_t value;
+            ssize_t n = ::read(fd, &value, sizeof(value));
+            (void)n;
+        }
+    }
+};
+
+// ============================================================================
+// ShmRingWriter
+// ============================================================================
+//
+// Producer side: an output stream buffer that writes into the ring.
+// The put area points into the ring's free space, so records are formatted
+// directly into shared memory.
+// 生産者側: リングに書き込む出力ストリームバッファ。書き込み領域はリングの
+// 空き領域を指すため、レコードは共有メモリ上に直接書式化される。
+//
+// ============================================================================
+class ShmRingWriter : public std::streambuf {
+public:
+    // Bytes written before write_pos is published / write_pos を公開するまでに書き込むバイト数
+    static constexpr size_t WINDOW = size_t(64) << 10;
+
+    // stop is an optional flag set once the consumer has closed the ring, so
+    // that the search producing the records can end early
+    // stop は読み手がリングを閉じた時点で設定する任意のフラグ。レコードを生成する
+    // 探索を早期に終了できるようにする
+    explicit ShmRingWriter(ShmRing& ring, std::atomic<bool>* stop = nullptr)
+        : ring(ring),
+        stop(stop),
+        position(ring.header().write_pos.load()) {}
+
+    ShmRingWriter(const ShmRingWriter&) = delete;
+    ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+
+    ~ShmRingWriter() override {
+        close(false);
+    }
+
+    // ------------------------------------------------------------------------
+    // close
+    // ------------------------------------------------------------------------
+    //
+    // Publishes the remaining output and ends the stream, as complete if
+    // success is true and nothing failed, otherwise as failed. Returns whether
+    // the stream ended as complete. Later calls do nothing.
+    // 残りの出力を公開してストリームを終了する。success が true で失敗がなければ
+    // 完了、そうでなければ失敗として終了する。完了として終了したかを返す。
+    // 2回目以降の呼び出しは何もしない。
+    //
+    // ------------------------------------------------------------------------
+    bool close(bool success) {
+        if (closed) return ok;
+        publish();
+        ok = ok && success;
+        closed = true;
+        ring.header().producer_state.store(ok ? ShmRing::PRODUCER_COMPLETE : ShmRing::PRODUCER_FAILED);
+        ring.notifyData();
+        return ok;
+    }
+
+    // Whether the consumer stopped reading / 読み手が読み取りをやめたか
+    bool consumerClosed() const {
+        return ring.header().consumer_closed.load() != 0;
+    }
+
+protected:
+    int overflow(int c) override {
+        publish();
+        if (!reserve()) return traits_type::eof();
+        if (c != traits_type::eof()) {
+            *pptr() = static_cast<char>(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        publish();
+        return ok ? 0 : -1;
+    }
+
+private:
+    ShmRing& ring;
+    std::atomic<bool>* stop;  // Set when the consumer closes (optional) / 読み手が閉じたときに設定（任意）
+    std::uint64_t position;  // Next byte to write / 次に書き込むバイトの位置
+    bool ok = true;
+    bool closed = false;
+
+    // Makes the bytes written so far visible to the consumer, and notices a
+    // consumer that has closed the ring while there was still free space
+    // これまでに書き込んだバイトを読み手から見えるようにし、空き領域が残っている
+    // うちにリングを閉じた読み手に気付く
+    void publish() {
+        size_t n = static_cast<size_t>(pptr() - pbase());
+        if (n == 0) return;
+        position += n;
+        setp(pptr(), epptr());
+        ShmRingHeader& h = ring.header();
+        h.write_pos.store(position);
+        if (h.consumer_waiting.load()) ring.notifyData();
+        if (h.consumer_closed.load()) consumerGone();
+    }
+
+    // Fails the stream after the consumer has closed the ring
+    // 読み手がリングを閉じた後、ストリームを失敗させる
+    void consumerGone() {
+        ok = false;
+        setp(nullptr, nullptr);
+        if (stop != nullptr) stop->store(true);
+    }
+
+    // Points the put area at the free space, waiting for space if the ring
+    // is full. Returns false if the consumer has closed the ring.
+    // 書き込み領域を空き領域に向ける。リングが満杯なら空きを待つ。
+    // 読み手がリングを閉じていれば false を返す。
+    bool reserve() {
+        ShmRingHeader& h = ring.header();
+        for (;;) {
+            if (h.consumer_closed.load()) {
+                consumerGone();
+                return false;
+            }
+            size_t free = ring.capacity() - static_cast<size_t>(position - h.read_pos.load());
+            if (free > 0) {
+                char* p = ring.data() + position % ring.capacity();
+                setp(p, p + std::min(free, WINDOW));
+                return true;
+            }
+            h.producer_waiting.store(1);
+            if (position - h.read_pos.load() == ring.capacity() && !h.consumer_closed.load()) {
+                ring.waitSpace();
+            }
+            h.producer_waiting.store(0);
+        }
+    }
+};
+
+// ============================================================================
+// ShmRingWatcher
+// ============================================================================
+//
+// Producer side: sets a flag once the consumer has closed the ring, checking
+// every WAIT_MS milliseconds on its own thread from construction until
+// destruction. ShmRingWriter only notices the consumer when it publishes or
+// waits for space; the watcher also covers a search that writes nothing for
+// a long time.
+// 生産者側: 読み手がリングを閉じた時点でフラグを設定する。構築から破棄まで、
+// 専用のスレッドで WAIT_MS ミリ秒ごとに確認する。ShmRingWriter が読み手に
+// 気付くのは公開時と空きを待つときだけだが、監視は長い間何も書き込まない探索も
+// 対象にする。
+//
+// ============================================================================
+class ShmRingWatcher {
+public:
+    ShmRingWatcher(const ShmRing& ring, std::atomic<bool>& stop)
+        : thread([this, &ring, &stop]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!finished) {
+                if (ring.header().consumer_closed.load() != 0) {
+                    stop.store(true);
+                    return;
+                }
+                wake.wait_for(lock, std::chrono::milliseconds(ShmRing::WAIT_MS));
+            }
+        }) {}
+
+    ShmRingWatcher(const ShmRingWatcher&) = delete;
+    ShmRingWatcher& operator=(const ShmRingWatcher&) = delete;
+
+    ~ShmRingWatcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+        }
+        wake.notify_all();
+        thread.join();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool finished = false;
+    std::thread thread;  // Declared last: starts after the members above / 最後に宣言: 上のメンバの後に開始する
+};
+
+// ============================================================================
+// ShmRingReader
+// ============================================================================
+//
+// Consumer side: returns the records of the ring in order, in place.
+// 読み手側: リングのレコードを順に、その場で返す。
+//
+// ============================================================================
+class ShmRingReader {
+public:
+    explicit ShmRingReader(ShmRing& ring)
+        : ring(ring),
+        position(ring.header().read_pos.load()),
+        published(position) {}
+
+    ShmRingReader(const ShmRingReader&) = delete;
+    ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+    // ------------------------------------------------------------------------
+    // next
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   record         : Reference to store a pointer to the next record
+    //   producer_alive : Optional check called while waiting; returning false
+    //                    means the producer exited without ending the stream
+    //
+    // 入力:
+    //   record         : 次のレコードへのポインタを格納する参照
+    //   producer_alive : 待機中に呼び出す任意の確認。false を返すと、生産者が
+    //                    ストリームを終了せずに終了したことを意味する
+    //
+    // Output:
+    //   Returns true with the next record, or false at the end of the stream
+    //   or on failure (see failed()).
+    //
+    // 出力:
+    //   次のレコードとともに true を返す。ストリームの終わり、または失敗時は
+    //   false を返す（failed() を参照）。
+    //
+    // Guarantee:
+    //   - The record points into the ring and stays valid until the next
+    //     call of next() or close()
+    //   - Blocks until a whole record is available
+    //
+    // 保証:
+    //   - レコードはリング内を指し、次の next() または close() の呼び出しまで有効
+    //   - レコード全体が利用可能になるまでブロックする
+    //
+    // ------------------------------------------------------------------------
+    bool next(const BinaryRecord::RecordHeader*& record,
+              const std::function<bool()>& producer_alive = nullptr) {
+        ShmRingHeader& h = ring.header();
+        position += pending;
+        pending = 0;
+        if (position - published >= ring.capacity() / 8) release();
+
+        for (;;) {
+            std::uint64_t written = h.write_pos.load();
+            std::uint64_t available = written - position;
+            const char* p = ring.data() + position % ring.capacity();
+            if (available >= sizeof(std::uint32_t)) {
+                std::uint32_t size;
+                std::memcpy(&size, p, sizeof(size));
+                if (size < sizeof(BinaryRecord::RecordHeader) || size % 8 != 0 || size >= ring.capacity()) {
+                    return fail("Invalid record size in shared-memory ring: " + std::to_string(size));
+                }
+                if (available >= size) {
+                    record = reinterpret_cast<const BinaryRecord::RecordHeader*>(p);
+                    pending = size;
+                    return true;
+                }
+            }
+
+            std::uint32_t state = h.producer_state.load();
+            if (state != ShmRing::PRODUCER_RUNNING) {
+                if (h.write_pos.load() != written) continue;
+                if (state == ShmRing::PRODUCER_COMPLETE && available == 0) {
+                    release();
+                    return false;
+                }
+                return fail(state == ShmRing::PRODUCER_COMPLETE
+                            ? "Shared-memory ring ended inside a record"
+                            : "Producer failed");
+            }
+            if (producer_alive && !producer_alive()) {
+                return fail("Producer exited without ending the shared-memory ring");
+            }
+
+            release();
+            h.consumer_waiting.store(1);
+            if (h.write_pos.load() == written && h.producer_state.load() == ShmRing::PRODUCER_RUNNING) {
+                ring.waitData();
+            }
+            h.consumer_waiting.store(0);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // close
+    // ------------------------------------------------------------------------
+    //
+    // Stops reading. A producer still writing then fails instead of waiting
+    // for space.
+    // 読み取りをやめる。まだ書き込み中の生産者は、空きを待たずに失敗する。
+    //
+    // ------------------------------------------------------------------------
+    void close() {
+        position += pending;
+        pending = 0;
+        release();
+        ring.header().consumer_closed.store(1);
+        ring.notifySpace();
+    }
+
+    // Whether next() stopped because of an error / next() がエラーで停止したか
+    bool failed() const { return has_failed; }
+
+private:
+    ShmRing& ring;
+    std::uint64_t position;   // Start of the current record / 現在のレコードの先頭
+    std::uint64_t published;  // Last read_pos published / 最後に公開した read_pos
+    std::uint64_t pending = 0;  // Size of the record handed out last / 最後に渡したレコードのサイズ
+    bool has_failed = false;
+
+    // Publishes read_pos, waking the producer if it waits for space
+    // read_pos を公開し、空きを待つ生産者がいれば起床させる
+    void release() {
+        if (position == published) return;
+        published = position;
+        ShmRingHeader& h = ring.header();
+        h.read_pos.store(position);
+        if (h.producer_waiting.load()) ring.notifySpace();
+    }
+
+    bool fail(const std::string& message) {
+        std::cerr << "Error: " << message << "\n";
+        has_failed = true;
+        close();
+        return false;
+    }
+};
+
+#endif  // REORG_SHM_RING_HPP
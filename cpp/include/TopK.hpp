@@ -0,0 +1,271 @@
+// ============================================================================
+// TopK.hpp
+// ============================================================================
+//
+// What this file does:
+//   Keeps the K candidates with the smallest endpoint slack found by the
+//   rotational unfolding search, across all worker threads.
+//
+// このファイルの役割:
+//   回転展開探索が見つけた候補のうち、端点スラックが最も小さい K 個を、
+//   すべてのワーカースレッドにわたって保持する。
+//
+// Responsibility in the project:
+//   - Defines the ranking of candidates (circle gap, then root pair, then path)
+//   - Keeps a bounded heap of candidates per worker
+//   - Publishes a shared K-th-best circle gap used for pruning
+//   - Merges the per-worker heaps into the final ranking
+//   - Does NOT run the search or write output
+//
+// プロジェクト内での責務:
+//   - 候補の順位付け（円ギャップ、次に root pair、次にパス）を定義
+//   - ワーカーごとに上限付きの候補ヒープを保持
+//   - 枝刈りに使用する、共有の K 番目に良い円ギャップを公開
+//   - ワーカーごとのヒープを最終的な順位にマージ
+//   - 探索の実行や出力の書き込みは担当しない
+//
+// Phase 1 における位置づけ:
+//   Support for the top-K search mode (--mode topk K), which reports only
+//   the tightest candidates instead of enumerating all of them.
+//   Phase 1では、すべての候補を列挙する代わりに最も厳しい候補のみを報告する
+//   top-K 探索モード（--mode topk K）を支える。
+//
+// Correctness:
+//   Every collector's K-th best gap is an upper bound of the global K-th best
+//   gap, so the shared threshold never drops below it. The search prunes only
+//   branches whose gap lower bound is strictly greater than the threshold,
+//   so every candidate of the final top K is found regardless of thread
+//   timing, and the result is deterministic.
+//   各コレクタの K 番目に良いギャップは全体の K 番目に良いギャップの上界であるため、
+//   共有閾値がそれを下回ることはない。探索はギャップの下界が閾値より真に大きい枝
+//   のみを刈り込むため、スレッドのタイミングによらず最終的な上位 K 個の候補は
+//   すべて見つかり、結果は決定的である。
+//
+// ============================================================================
+
+#ifndef REORG_TOP_K_HPP
+#define REORG_TOP_K_HPP
+
+#include "UnfoldedFace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// ============================================================================
+// TopKCandidate
+// ============================================================================
+//
+// A candidate partial unfolding together with its ranking key.
+// 順位付けのキーを伴う候補の部分展開図。
+//
+// ============================================================================
+struct TopKCandidate {
+    double circle_gap;                // Endpoint slack (smaller = tighter) / 端点スラック（小さいほど厳しい）
+    int root_index;                   // Index into the root pair list / root pair リスト内の番号
+    int base_face;                    // ID of the base face / 基準面のID
+    int base_edge;                    // ID of the base edge / 基準辺のID
+    std::vector<UnfoldedFace> faces;  // Path of the partial unfolding / 部分展開図のパス
+
+    // ------------------------------------------------------------------------
+    // Ranking: smaller circle gap first, then root pair order, then the
+    // (face_id, edge_id) sequence of the path. This is a strict total order
+    // on distinct candidates.
+    // 順位: 円ギャップの小さい順、次に root pair の順、次にパスの
+    // (face_id, edge_id) 列の順。異なる候補に対する狭義の全順序である。
+    // ------------------------------------------------------------------------
+    bool operator<(const TopKCandidate& other) const {
+        if (circle_gap != other.circle_gap) return circle_gap < other.circle_gap;
+        if (root_index != other.root_index) return root_index < other.root_index;
+        return std::lexicographical_compare(
+            faces.begin(), faces.end(), other.faces.begin(), other.faces.end(),
+            [](const UnfoldedFace& a, const UnfoldedFace& b) {
+                return a.face_id != b.face_id ? a.face_id < b.face_id : a.edge_id < b.edge_id;
+            });
+    }
+};
+
+// ============================================================================
+// TopKThreshold
+// ============================================================================
+//
+// Shared K-th-best circle gap, lowered by collectors as they fill up.
+// コレクタが埋まるにつれて引き下げられる、共有の K 番目に良い円ギャップ。
+//
+// ============================================================================
+class TopKThreshold {
+public:
+    double get() const { return value.load(std::memory_order_relaxed); }
+
+    // Lowers the threshold to gap if gap is smaller
+    // gap の方が小さければ閾値を gap に引き下げる
+    void lower(double gap) {
+        double current = value.load(std::memory_order_relaxed);
+        while (gap < current
+               && !value.compare_exchange_weak(current, gap, std::memory_order_relaxed)) {
+        }
+    }
+
+private:
+    std::atomic<double> value{std::numeric_limits<double>::infinity()};
+};
+
+// ============================================================================
+// TopKCollector
+// ============================================================================
+//
+// Per-worker bounded heap of the best K candidates seen by that worker.
+// ワーカーごとの、そのワーカーが見た上位 K 個の候補を保持する上限付きヒープ。
+//
+// Responsibility:
+//   - Accepts candidates from RotationalUnfolding at emit time
+//   - Provides the pruning threshold to RotationalUnfolding
+//
+// 責務:
+//   - 出力時に RotationalUnfolding から候補を受け取る
+//   - RotationalUnfolding に枝刈りの閾値を提供する
+//
+// Does NOT handle:
+//   - Synchronization of the heap (one collector per thread)
+//
+// 責務外:
+//   - ヒープの同期（コレクタはスレッドごとに1つ）
+//
+// ============================================================================
+class TopKCollector {
+public:
+    TopKCollector(size_t k, TopKThreshold& shared)
+        : k(k), shared(shared) {}
+
+    // ------------------------------------------------------------------------
+    // setRoot
+    // ------------------------------------------------------------------------
+    //
+    // Sets the root pair of the candidates offered next.
+    // 次に渡される候補の root pair を設定する。
+    //
+    // ------------------------------------------------------------------------
+    void setRoot(int index, int face, int edge) {
+        root_index = index;
+        base_face = face;
+        base_edge = edge;
+    }
+
+    // ------------------------------------------------------------------------
+    // threshold
+    // ------------------------------------------------------------------------
+    //
+    // Circle gap above which no candidate can enter the top K.
+    // Branches whose gap lower bound exceeds it may be pruned.
+    // これを超える円ギャップの候補は上位 K 個に入れない。
+    // ギャップの下界がこれを超える枝は刈り込んでよい。
+    //
+    // ------------------------------------------------------------------------
+    double threshold() const { return shared.get(); }
+
+    // ------------------------------------------------------------------------
+    // offer
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   circle_gap : Endpoint slack of the candidate
+    //   faces      : Path of the candidate (copied only if within the threshold)
+    //
+    // 入力:
+    //   circle_gap : 候補の端点スラック
+    //   faces      : 候補のパス（閾値以内の場合のみコピーされる）
+    //
+    // Guarantee:
+    //   - Keeps the candidate if it ranks among the best K seen by this
+    //     collector, evicting the worst one if the heap is full
+    //   - Once the heap is full, lowers the shared threshold to the worst
+    //     kept circle gap
+    //
+    // 保証:
+    //   - このコレクタが見た上位 K 個に入る場合は候補を保持し、ヒープが満杯なら
+    //     最悪の候補を取り除く
+    //   - ヒープが満杯になった後は、共有閾値を保持中の最悪の円ギャップまで引き下げる
+    //
+    // ------------------------------------------------------------------------
+    void offer(double circle_gap, const std::vector<UnfoldedFace>& faces) {
+        if (circle_gap > shared.get()) return;
+
+        TopKCandidate candidate = {circle_gap, root_index, base_face, base_edge, faces};
+        if (heap.size() < k) {
+            heap.push_back(std::move(candidate));
+            std::push_heap(heap.begin(), heap.end());
+        } else if (candidate < heap.front()) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = std::move(candidate);
+            std::push_heap(heap.begin(), heap.end());
+        } else {
+            return;
+        }
+
+        if (heap.size() == k) {
+            shared.lower(heap.front().circle_gap);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // takeCandidates
+    // ------------------------------------------------------------------------
+    //
+    // Moves the kept candidates out of the collector (in no particular order).
+    // 保持している候補をコレクタから取り出す（順不同）。
+    //
+    // ------------------------------------------------------------------------
+    std::vector<TopKCandidate> takeCandidates() {
+        std::vector<TopKCandidate> out;
+        out.swap(heap);
+        return out;
+    }
+
+private:
+    size_t k;
+    TopKThreshold& shared;
+    int root_index = -1;
+    int base_face = -1;
+    int base_edge = -1;
+
+    // Max-heap by ranking: front() is the worst kept candidate
+    // 順位による最大ヒープ: front() は保持中の最悪の候補
+    std::vector<TopKCandidate> heap;
+};
+
+// ----------------------------------------------------------------------------
+// mergeTopK
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   collectors : Candidates taken from every collector
+//   k          : Number of candidates to keep
+//
+// 入力:
+//   collectors : すべてのコレクタから取り出した候補
+//   k          : 保持する候補数
+//
+// Output:
+//   The best k candidates in ranking order.
+//
+// 出力:
+//   順位順の上位 k 個の候補。
+//
+// ----------------------------------------------------------------------------
+inline std::vector<TopKCandidate> mergeTopK(std::vector<std::vector<TopKCandidate>> collectors,
+                                            size_t k) {
+    std::vector<TopKCandidate> all;
+    for (auto& c : collectors) {
+        for (auto& candidate : c) {
+            all.push_back(std::move(candidate));
+        }
+    }
+    std::sort(all.begin(), all.end());
+    if (all.size() > k) {
+        all.erase(all.begin() + static_cast<std::ptrdiff_t>(k), all.end());
+    }
+    return all;
+}
+
+#endif  // REORG_TOP_K_HPP
@@ -0,0 +1,148 @@
+// ============================================================================
+// WorkQueue.hpp
+// ============================================================================
+//
+// What this file does:
+//   Distributes work items among NUMA nodes and hands them out to worker
+//   threads, stealing from the nearest other node when a node runs out.
+//
+// このファイルの役割:
+//   作業項目を NUMA ノード間に分配してワーカースレッドに渡し、あるノードの
+//   項目がなくなった場合は最も近い他のノードから奪う。
+//
+// Responsibility in the project:
+//   - Splits an ordered list of items into per-node queues
+//   - Pops items lock-free, local node first, then by node distance
+//   - Counts local and stolen items per node
+//   - Does NOT own threads or decide placement (see CpuTopology)
+//
+// プロジェクト内での責務:
+//   - 順序付きの項目列をノードごとのキューに分割
+//   - ロックなしで項目を取り出す（自ノードを優先し、その後ノード距離順）
+//   - ノードごとにローカルに処理した項目と奪った項目を数える
+//   - スレッドの所有や配置の決定は担当しない（CpuTopology を参照）
+//
+// Phase 1 における位置づけ:
+//   Scheduler of ParallelRunner. With a single node it is the same shared
+//   counter over the schedule as before, so single-socket runs are unchanged.
+//   Phase 1では、ParallelRunner のスケジューラ。ノードが1つの場合は、従来と同じ
+//   スケジュール上の共有カウンタとなり、シングルソケットでの実行は変わらない。
+//
+// ============================================================================
+
+#ifndef REORG_WORK_QUEUE_HPP
+#define REORG_WORK_QUEUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// ============================================================================
+// NodeWorkQueue
+// ============================================================================
+//
+// Work items 0..n-1, dealt round-robin to nodes: node q owns the items
+// q, q + num_nodes, q + 2 * num_nodes, ... and hands them out in that order.
+// Because items are dealt in schedule order, each node receives its share of
+// the longest items first.
+// 作業項目 0..n-1 をノードに順番に配る: ノード q は項目 q, q + num_nodes,
+// q + 2 * num_nodes, ... を持ち、その順に渡す。項目はスケジュール順に配られるため、
+// 各ノードは長い項目の取り分から先に受け取る。
+//
+// ============================================================================
+class NodeWorkQueue {
+public:
+    // ------------------------------------------------------------------------
+    // Constructor
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   n       : Number of work items
+    //   victims : For each node, the other nodes to steal from, nearest first
+    //             (victims.size() is the number of nodes, >= 1)
+    //
+    // 入力:
+    //   n       : 作業項目数
+    //   victims : 各ノードについて、項目を奪う他のノード（近い順）
+    //             （victims.size() がノード数、1 以上）
+    //
+    // ------------------------------------------------------------------------
+    NodeWorkQueue(size_t n, const std::vector<std::vector<int>>& victims)
+        : num_items(n),
+        victims(victims),
+        nodes(new NodeState[victims.size()]) {}
+
+    // ------------------------------------------------------------------------
+    // pop
+    // ------------------------------------------------------------------------
+    //
+    // Input:
+    //   node : Node of the calling worker
+    //   item : Reference to store the item
+    //
+    // 入力:
+    //   node : 呼び出したワーカーのノード
+    //   item : 項目を格納する参照
+    //
+    // Output:
+    //   Returns false when no items remain on any node.
+    //
+    // 出力:
+    //   どのノードにも項目が残っていない場合は false を返す。
+    //
+    // Guarantee:
+    //   - Every item is returned exactly once
+    //
+    // 保証:
+    //   - すべての項目はちょうど1回返される
+    //
+    // ------------------------------------------------------------------------
+    bool pop(int node, size_t& item) {
+        if (take(node, item)) {
+            nodes[node].local.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        for (int victim : victims[node]) {
+            if (take(victim, item)) {
+                nodes[node].stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Number of nodes / ノード数
+    int numNodes() const { return static_cast<int>(victims.size()); }
+
+    // Items run by workers of node from its own queue / ノードのワーカーが自ノードのキューから処理した項目数
+    size_t localItems(int node) const { return nodes[node].local.load(); }
+
+    // Items run by workers of node taken from other nodes / ノードのワーカーが他ノードから奪った項目数
+    size_t stolenItems(int node) const { return nodes[node].stolen.load(); }
+
+private:
+    // Per-node state, on its own cache line to avoid false sharing
+    // ノードごとの状態。偽共有を避けるため個別のキャッシュラインに置く
+    struct alignas(64) NodeState {
+        std::atomic<size_t> next{0};    // Cursor into the node's items / ノードの項目のカーソル
+        std::atomic<size_t> local{0};
+        std::atomic<size_t> stolen{0};
+    };
+
+    size_t num_items;
+    std::vector<std::vector<int>> victims;
+    std::unique_ptr<NodeState[]> nodes;
+
+    // Takes the next item of node q, if any
+    // ノード q の次の項目があれば取り出す
+    bool take(int q, size_t& item) {
+        const size_t stride = victims.size();
+        if (nodes[q].next.load(std::memory_order_relaxed) * stride + q >= num_items) {
+            return false;
+        }
+        item = nodes[q].next.fetch_add(1) * stride + q;
+        return item < num_items;
+    }
+};
+
+#endif  // REORG_WORK_QUEUE_HPP
@@ -13,18 +13,28 @@
 //   探索を実行し、結果をJSONL形式で出力する。
 //
 // Responsibility in the project:
-//   - Parses CLI arguments (--polyhedron, --roots, --symmetric, --out)
+//   - Parses CLI arguments (--polyhedron, --roots, --symmetric, --out,
+//     --out-dir, --emit-buffer, --tag-slack, --threads, --pin, --cost-model,
+//     --mode, --reorder-mem-cap, --index, --roots-subset, --shm-ring)
 //   - Loads polyhedron data from JSON using IOUtil
-//   - Invokes RotationalUnfolding for each root pair
-//   - Manages output streams (stdout or file)
+//   - Estimates per-root costs from the cost model or by probing
+//   - Invokes RotationalUnfolding for each root pair via ParallelRunner
+//   - Manages output streams (stdout, file, per-task files with a manifest,
+//     or a shared-memory ring of binary records)
+//   - Re-runs a subset of root pairs and splices it into an indexed output
 //   - Reports progress to stderr
 //   - Does NOT contain algorithm logic
 //
 // プロジェクト内での責務:
-//   - CLI引数を解析（--polyhedron, --roots, --symmetric, --out）
+//   - CLI引数を解析（--polyhedron, --roots, --symmetric, --out,
+//     --out-dir, --emit-buffer, --tag-slack, --threads, --pin, --cost-model,
+//     --mode, --reorder-mem-cap, --index, --roots-subset, --shm-ring）
 //   - IOUtil を使用してJSONから多面体データを読み込み
-//   - 各 root pair について RotationalUnfolding を呼び出し
-//   - 出力ストリームを管理（stdout またはファイル）
+//   - コストモデルまたはプローブにより root pair ごとのコストを見積もる
+//   - ParallelRunner を介して各 root pair について RotationalUnfolding を呼び出し
+//   - 出力ストリームを管理（stdout、ファイル、マニフェスト付きのタスクごとのファイル、
+//     またはバイナリレコードの共有メモリリング）
+//   - root pair の一部を再実行し、索引付きの出力に結合
 //   - 進捗を stderr に報告
 //   - アルゴリズムロジックは含まない
 //
@@ -39,12 +49,34 @@
 // ============================================================================
 
 #include "RotationalUnfolding.hpp"
+#include "ParallelRunner.hpp"
+#include "CostModel.hpp"
+#include "OutputIndex.hpp"
+#include "ShmRing.hpp"
 #include "IOUtil.hpp"
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
+#include <map>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <atomic>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+// Node limit per root pair when probing costs without run history.
+// 実行履歴がない場合にコストをプローブする際の root pair ごとのノード数上限。
+// ----------------------------------------------------------------------------
+constexpr long long PROBE_NODE_LIMIT = 20000;
 
 // ============================================================================
 // CLI Argument Parsing
@@ -63,6 +95,16 @@ struct CliArgs {
     std::string roots_path;      // Path to root_pairs.json
     std::string symmetric_mode;  // Symmetry mode: "auto", "on", or "off"
     std::string out_path;        // Output file path (empty = stdout)
+    std::string out_dir;         // Per-task output directory (empty = single stream)
+    SearchOptions search_options; // Emit tolerance and output tagging options
+    int num_threads = 0;         // Number of worker threads (0 = CPUs available to the process)
+    bool pin_threads = false;    // Pin each worker thread to one CPU
+    std::string cost_model_path; // Path to the cost model file (empty = none)
+    long long top_k = 0;         // Candidates kept in the top-K mode (0 = enumerate all)
+    size_t reorder_mem_cap = ReorderBuffer::DEFAULT_MEMORY_CAP; // Out-of-order output kept in memory (bytes)
+    std::string index_path;      // Byte-offset index of the output (empty = none)
+    std::string roots_subset;    // Root pairs to re-run and splice (empty = all)
+    std::string shm_ring;        // Shared-memory ring descriptors "MEM,DATA,SPACE" (empty = none)
 
     bool valid = false;          // Whether parsing succeeded
 };
@@ -76,17 +118,70 @@ struct CliArgs {
 //
 // ----------------------------------------------------------------------------
 void printUsage(const char* program_name) {
-    std::cerr << "Usage: " << program_name << " --polyhedron PATH --roots PATH --symmetric auto|on|off [--out PATH]\n";
+    std::cerr << "Usage: " << program_name << " --polyhedron PATH --roots PATH --symmetric auto|on|off [--out PATH | --out-dir DIR]\n";
+    std::cerr << "       [--emit-buffer VALUE] [--tag-slack] [--threads N] [--pin] [--cost-model PATH]\n";
+    std::cerr << "       [--mode all | --mode topk K] [--reorder-mem-cap SIZE]\n";
+    std::cerr << "       [--index PATH [--roots-subset LIST]] [--shm-ring MEMFD,DATAFD,SPACEFD]\n";
     std::cerr << "\n";
     std::cerr << "Options:\n";
     std::cerr << "  --polyhedron PATH   Path to the polyhedron.json file\n";
     std::cerr << "  --roots PATH        Path to the root_pairs.json file\n";
     std::cerr << "  --symmetric MODE    Symmetry mode: auto (from polyhedron name), on, or off\n";
     std::cerr << "  --out PATH          Output file path (optional; stdout if not specified)\n";
+    std::cerr << "  --out-dir DIR       Write one file per task and a manifest.json into DIR\n";
+    std::cerr << "  --emit-buffer VALUE Emit tolerance added to the circumradius sum (default: 0.01)\n";
+    std::cerr << "  --tag-slack         Append endpoint_slack (circle gap) to each record\n";
+    std::cerr << "  --threads N         Number of worker threads (default: CPUs allowed by the affinity\n";
+    std::cerr << "                      mask and the cgroup CPU quota)\n";
+    std::cerr << "  --pin               Pin workers to CPUs, node by node, with NUMA-local scheduling\n";
+    std::cerr << "  --cost-model PATH   Cost model file used to order work and updated after the run\n";
+    std::cerr << "  --mode all          Write every candidate in root-pair order (default)\n";
+    std::cerr << "  --mode topk K       Write only the K candidates with the smallest endpoint slack\n";
+    std::cerr << "  --reorder-mem-cap SIZE\n";
+    std::cerr << "                      Out-of-order output kept in memory before spilling to $TMPDIR\n";
+    std::cerr << "                      (bytes, or with suffix K, M, G; default: 1G)\n";
+    std::cerr << "  --index PATH        Write the byte-offset index of --out (per root pair) to PATH\n";
+    std::cerr << "  --roots-subset LIST Re-run only these root pairs and splice them into the existing\n";
+    std::cerr << "                      --out file, then rewrite --index. LIST is comma-separated root\n";
+    std::cerr << "                      indices (0-based, ranges like 3-7) or FACE:EDGE base pairs\n";
+    std::cerr << "  --shm-ring FDS      Write binary records to the shared-memory ring created by the\n";
+    std::cerr << "                      parent process (inherited memfd and data/space eventfds)\n";
     std::cerr << "\n";
     std::cerr << "Output format: JSONL (JSON Lines) - one partial unfolding per line\n";
 }
 
+// ----------------------------------------------------------------------------
+// parseByteSize
+// ----------------------------------------------------------------------------
+//
+// Parses a byte count with an optional binary suffix (K, M, G), e.g. "512M".
+// Returns false if text is not a non-negative size.
+// 省略可能な2進接尾辞（K, M, G）付きのバイト数を解析する。例: "512M"。
+// text が非負のサイズでなければ false を返す。
+//
+// ----------------------------------------------------------------------------
+bool parseByteSize(const std::string& text, size_t& bytes) {
+    size_t pos = 0;
+    unsigned long long value = 0;
+    try {
+        if (text.empty() || text[0] == '-') return false;
+        value = std::stoull(text, &pos);
+    } catch (...) {
+        return false;
+    }
+
+    std::string suffix = text.substr(pos);
+    int shift = 0;
+    if (suffix == "K" || suffix == "k") shift = 10;
+    else if (suffix == "M" || suffix == "m") shift = 20;
+    else if (suffix == "G" || suffix == "g") shift = 30;
+    else if (!suffix.empty()) return false;
+
+    if (value > (std::numeric_limits<size_t>::max() >> shift)) return false;
+    bytes = static_cast<size_t>(value) << shift;
+    return true;
+}
+
 // ----------------------------------------------------------------------------
 // parseArgs
 // ----------------------------------------------------------------------------
@@ -110,12 +205,22 @@ void printUsage(const char* program_name) {
 // Guarantee:
 //   - Validates required arguments (--polyhedron, --roots, --symmetric)
 //   - Validates symmetric_mode is one of: auto, on, off
+//   - Validates --emit-buffer is a finite, non-negative number with no trailing characters
+//   - Validates --threads is a positive integer
+//   - Validates --mode is all or topk, and K of topk is a positive integer
+//   - Validates --reorder-mem-cap is a byte size
+//   - Validates --index is used with --out, and --roots-subset with --index
 //   - Writes error messages to stderr on failure
 //   - No side effects beyond stderr output
 //
 // 保証:
 //   - 必須引数（--polyhedron, --roots, --symmetric）を検証
 //   - symmetric_mode が auto, on, off のいずれかであることを検証
+//   - --emit-buffer が末尾に余分な文字のない有限の非負数値であることを検証
+//   - --threads が正の整数であることを検証
+//   - --mode が all または topk であり、topk の K が正の整数であることを検証
+//   - --reorder-mem-cap がバイト数であることを検証
+//   - --index が --out と、--roots-subset が --index と併用されることを検証
 //   - 失敗時に stderr にエラーメッセージを書き込み
 //   - stderr 出力以外の副作用はない
 //
@@ -149,6 +254,91 @@ CliArgs parseArgs(int argc, char* argv[]) {
         else if (arg == "--out" && i + 1 < argc) {
             args.out_path = argv[++i];
         }
+        else if (arg == "--out-dir" && i + 1 < argc) {
+            args.out_dir = argv[++i];
+        }
+        else if (arg == "--emit-buffer" && i + 1 < argc) {
+            std::string text = argv[++i];
+            size_t pos = 0;
+            double value = -1.0;
+            try {
+                value = std::stod(text, &pos);
+            } catch (...) {
+                pos = 0;
+            }
+            // Reject trailing characters, nan, and inf
+            // 末尾の余分な文字、nan、inf を拒否
+            if (pos == 0 || pos != text.size() || !std::isfinite(value)) {
+                std::cerr << "Error: --emit-buffer must be a number\n";
+                return args;
+            }
+            if (value < 0.0) {
+                std::cerr << "Error: --emit-buffer must be non-negative\n";
+                return args;
+            }
+            args.search_options.emit_buffer = value;
+        }
+        else if (arg == "--tag-slack") {
+            args.search_options.tag_slack = true;
+        }
+        else if (arg == "--pin") {
+            args.pin_threads = true;
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            try {
+                args.num_threads = std::stoi(argv[++i]);
+            } catch (...) {
+                args.num_threads = -1;
+            }
+            if (args.num_threads < 1) {
+                std::cerr << "Error: --threads must be a positive integer\n";
+                return args;
+            }
+        }
+        else if (arg == "--reorder-mem-cap" && i + 1 < argc) {
+            if (!parseByteSize(argv[++i], args.reorder_mem_cap)) {
+                std::cerr << "Error: --reorder-mem-cap must be a size in bytes (suffix K, M, or G allowed)\n";
+                return args;
+            }
+        }
+        else if (arg == "--index" && i + 1 < argc) {
+            args.index_path = argv[++i];
+        }
+        else if (arg == "--roots-subset" && i + 1 < argc) {
+            args.roots_subset = argv[++i];
+            if (args.roots_subset.empty()) {
+                std::cerr << "Error: --roots-subset must not be empty\n";
+                return args;
+            }
+        }
+        else if (arg == "--shm-ring" && i + 1 < argc) {
+            args.shm_ring = argv[++i];
+            args.search_options.binary_records = true;
+        }
+        else if (arg == "--cost-model" && i + 1 < argc) {
+            args.cost_model_path = argv[++i];
+        }
+        else if (arg == "--mode" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "all") {
+                args.top_k = 0;
+            }
+            else if (mode == "topk" && i + 1 < argc) {
+                try {
+                    args.top_k = std::stoll(argv[++i]);
+                } catch (...) {
+                    args.top_k = -1;
+                }
+                if (args.top_k < 1) {
+                    std::cerr << "Error: --mode topk requires a positive integer K\n";
+                    return args;
+                }
+            }
+            else {
+                std::cerr << "Error: --mode must be all or topk K\n";
+                return args;
+            }
+        }
         else {
             std::cerr << "Error: Unknown argument: " << arg << "\n";
             return args;
@@ -162,10 +352,402 @@ CliArgs parseArgs(int argc, char* argv[]) {
         return args;
     }
 
+    if (!args.out_dir.empty() && !args.out_path.empty()) {
+        std::cerr << "Error: --out and --out-dir cannot be used together\n";
+        return args;
+    }
+    if (!args.out_dir.empty() && args.top_k > 0) {
+        std::cerr << "Error: --out-dir cannot be used with --mode topk\n";
+        return args;
+    }
+    if (!args.index_path.empty() && (args.out_path.empty() || args.top_k > 0)) {
+        std::cerr << "Error: --index requires --out and cannot be used with --mode topk\n";
+        return args;
+    }
+    if (!args.shm_ring.empty() && (!args.out_path.empty() || !args.out_dir.empty())) {
+        std::cerr << "Error: --shm-ring cannot be used with --out or --out-dir\n";
+        return args;
+    }
+    if (!args.roots_subset.empty() && args.index_path.empty()) {
+        std::cerr << "Error: --roots-subset requires --out and --index\n";
+        return args;
+    }
+
     args.valid = true;
     return args;
 }
 
+// ============================================================================
+// Work Planning
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// estimateRootCosts
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   runner     : ParallelRunner used for probing
+//   root_pairs : List of (base_face, base_edge) pairs
+//   history    : Costs recorded by previous runs (may be empty)
+//   threads    : Number of worker threads
+//
+// 入力:
+//   runner     : プローブに使用する ParallelRunner
+//   root_pairs : (基準面, 基準辺) ペアのリスト
+//   history    : 過去の実行で記録されたコスト（空でもよい）
+//   threads    : ワーカースレッド数
+//
+// Output:
+//   Predicted cost of each root pair, used to order and split work.
+//
+// 出力:
+//   各 root pair の予測コスト。作業の順序付けと分割に使用する。
+//
+// Guarantee:
+//   - If history covers every root pair, costs are recorded wall times and
+//     the predicted total runtime is reported to stderr
+//   - Otherwise, with more than one thread, costs are node counts from a
+//     node-limited probe (PROBE_NODE_LIMIT nodes per root pair)
+//   - With one thread and no complete history, all costs are zero
+//     (work runs in root-pair order and nothing needs to be planned)
+//
+// 保証:
+//   - history がすべての root pair を含む場合、コストは記録された経過時間であり、
+//     予測総実行時間を stderr に報告する
+//   - そうでなく複数スレッドの場合、コストはノード数上限付きプローブ
+//     （root pair ごとに PROBE_NODE_LIMIT ノード）のノード数である
+//   - 1スレッドで完全な履歴がない場合、すべてのコストは 0
+//     （作業は root pair 順に実行され、計画は不要）
+//
+// ----------------------------------------------------------------------------
+std::vector<double> estimateRootCosts(
+    const ParallelRunner& runner,
+    const std::vector<std::pair<int, int>>& root_pairs,
+    const std::map<std::pair<int, int>, CostModel::RootCost>& history,
+    int threads)
+{
+    std::vector<double> costs(root_pairs.size(), 0.0);
+
+    bool complete_history = !history.empty();
+    for (size_t i = 0; i < root_pairs.size() && complete_history; ++i) {
+        auto it = history.find(root_pairs[i]);
+        if (it == history.end()) {
+            complete_history = false;
+        } else {
+            costs[i] = it->second.seconds;
+        }
+    }
+
+    if (complete_history) {
+        double total = 0.0;
+        for (double c : costs) {
+            total += c;
+        }
+        std::cerr << "Info: Cost model: history found for all " << root_pairs.size() << " root pairs\n";
+        std::cerr << "Info: Predicted runtime: " << total / threads
+                  << " s (" << total << " s of search on " << threads << " threads)\n";
+        return costs;
+    }
+
+    std::fill(costs.begin(), costs.end(), 0.0);
+    if (threads == 1) {
+        return costs;
+    }
+
+    std::cerr << "Info: Cost model: no complete history; probing " << root_pairs.size()
+              << " root pairs (up to " << PROBE_NODE_LIMIT << " nodes each)\n";
+    std::vector<long long> probe = runner.probeRoots(root_pairs, PROBE_NODE_LIMIT);
+    for (size_t i = 0; i < root_pairs.size(); ++i) {
+        costs[i] = static_cast<double>(probe[i]);
+    }
+    return costs;
+}
+
+// ============================================================================
+// Root Subsets and Splicing
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// parseRootsSubset
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   spec       : Comma-separated root indices (0-based), index ranges
+//                ("3-7"), or base pairs ("FACE:EDGE")
+//   root_pairs : List of (base_face, base_edge) pairs
+//   subset     : Reference to store the selected root indices
+//
+// 入力:
+//   spec       : カンマ区切りの root の番号（0始まり）、番号の範囲（"3-7"）、
+//                または基準ペア（"FACE:EDGE"）
+//   root_pairs : (基準面, 基準辺) ペアのリスト
+//   subset     : 選択された root の番号を格納する参照
+//
+// Output:
+//   Returns true on success; false (with an error on std::cerr) if an entry
+//   is malformed or does not name a root pair.
+//   subset is sorted and free of duplicates.
+//
+// 出力:
+//   成功時は true。項目の形式が不正、または root pair を指していない場合は
+//   false を返す（std::cerr にエラーを出力）。subset はソート済みで重複を含まない。
+//
+// ----------------------------------------------------------------------------
+bool parseRootsSubset(const std::string& spec,
+                      const std::vector<std::pair<int, int>>& root_pairs,
+                      std::vector<int>& subset) {
+    const int num_roots = static_cast<int>(root_pairs.size());
+    std::vector<char> selected(root_pairs.size(), 0);
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t comma = spec.find(',', start);
+        if (comma == std::string::npos) comma = spec.size();
+        std::string item = spec.substr(start, comma - start);
+        start = comma + 1;
+
+        int first = -1, last = -1;
+        try {
+            size_t colon = item.find(':');
+            size_t dash = item.find('-');
+            if (colon != std::string::npos) {
+                std::pair<int, int> pair(std::stoi(item.substr(0, colon)),
+                                         std::stoi(item.substr(colon + 1)));
+                auto it = std::find(root_pairs.begin(), root_pairs.end(), pair);
+                if (it != root_pairs.end()) {
+                    first = last = static_cast<int>(it - root_pairs.begin());
+                }
+            } else if (dash != std::string::npos && dash > 0) {
+                first = std::stoi(item.substr(0, dash));
+                last = std::stoi(item.substr(dash + 1));
+            } else {
+                first = last = std::stoi(item);
+            }
+        } catch (...) {
+            first = -1;
+        }
+
+        if (first < 0 || last < first || last >= num_roots) {
+            std::cerr << "Error: --roots-subset: invalid entry \"" << item << "\" ("
+                      << num_roots << " root pairs)\n";
+            return false;
+        }
+        for (int r = first; r <= last; ++r) {
+            selected[r] = 1;
+        }
+    }
+
+    subset.clear();
+    for (int r = 0; r < num_roots; ++r) {
+        if (selected[r]) subset.push_back(r);
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// loadExistingIndex
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   out_path   : Existing output file to splice into
+//   index_path : Its byte-offset index
+//   root_pairs : List of (base_face, base_edge) pairs
+//   index      : Reference to store the index
+//
+// 入力:
+//   out_path   : 結合先の既存の出力ファイル
+//   index_path : そのバイトオフセット索引
+//   root_pairs : (基準面, 基準辺) ペアのリスト
+//   index      : 索引を格納する参照
+//
+// Output:
+//   Returns true if index describes out_path for these root pairs.
+//
+// 出力:
+//   index がこれらの root pair についての out_path を記述していれば true を返す。
+//
+// Guarantee:
+//   - An index that cannot be read, or whose size, checksum, or root pairs
+//     do not match the file, is rebuilt by scanning the file (with a
+//     warning, not an error); a missing index too
+//
+// 保証:
+//   - 読み込めない索引、またはサイズ、チェックサム、root pair がファイルと
+//     一致しない索引は、ファイルの走査により再構築される（エラーではなく警告付き）。
+//     索引がない場合も同様
+//
+// ----------------------------------------------------------------------------
+bool loadExistingIndex(const std::string& out_path,
+                       const std::string& index_path,
+                       const std::vector<std::pair<int, int>>& root_pairs,
+                       OutputIndex& index) {
+    MappedFile file;
+    if (!file.open(out_path)) {
+        std::cerr << "Error: --roots-subset needs an existing output file: " << out_path << "\n";
+        return false;
+    }
+
+    // A corrupt index is rebuilt like a stale one, so it is only a warning
+    // 壊れた索引も古い索引と同様に再構築するため、警告にとどめる
+    std::string error;
+    if (!std::filesystem::exists(index_path)) {
+        std::cerr << "Info: No index for " << out_path << "; building it\n";
+    } else if (!index.load(index_path, &error)) {
+        std::cerr << "Warning: " << error << "; rebuilding it\n";
+    } else {
+        bool matches = index.roots.size() == root_pairs.size()
+                    && index.num_bytes == static_cast<long long>(file.size())
+                    && index.checksum == HashUtil::fnv1a64(file.data(), file.size());
+        for (size_t r = 0; r < root_pairs.size() && matches; ++r) {
+            matches = index.roots[r].base_face == root_pairs[r].first
+                   && index.roots[r].base_edge == root_pairs[r].second;
+        }
+        if (matches) {
+            return true;
+        }
+        std::cerr << "Warning: Index does not match " << out_path << "; rebuilding it\n";
+    }
+
+    if (!index.scan(file.data(), file.size(), root_pairs)) {
+        std::cerr << "Error: Cannot index " << out_path << "\n";
+        return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// createTempFile
+// ----------------------------------------------------------------------------
+//
+// Creates a new, uniquely named empty file next to target_path (as
+// target_path + ".XXXXXX") and stores its name in tmp_path. Returns false
+// on failure (with an error on std::cerr).
+// target_path の隣に一意な名前の空ファイル（target_path + ".XXXXXX"）を作成し、
+// その名前を tmp_path に格納する。失敗時は false を返す（std::cerr にエラーを出力）。
+//
+// Concurrent runs on the same output each get their own file, and a file
+// renamed over target_path stays on the same file system.
+// 同じ出力に対する同時実行はそれぞれ専用のファイルを得る。また target_path に
+// リネームするファイルは同じファイルシステム上に置かれる。
+//
+// ----------------------------------------------------------------------------
+bool createTempFile(const std::string& target_path, std::string& tmp_path) {
+    tmp_path = target_path + ".XXXXXX";
+    int fd = ::mkstemp(&tmp_path[0]);
+    if (fd < 0) {
+        std::cerr << "Error: Cannot create a temporary file next to " << target_path << "\n";
+        return false;
+    }
+    ::fchmod(fd, 0644);
+    ::close(fd);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// spliceSubset
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   out_path    : Existing output file (described by old_index)
+//   old_index   : Index of out_path
+//   subset      : Re-run root indices (sorted)
+//   subset_path : Output of the re-run, in the order of subset
+//   root_pairs  : List of (base_face, base_edge) pairs
+//   new_index   : Reference to store the index of the spliced file
+//
+// 入力:
+//   out_path    : 既存の出力ファイル（old_index が記述する）
+//   old_index   : out_path の索引
+//   subset      : 再実行した root の番号（ソート済み）
+//   subset_path : 再実行の出力（subset の順）
+//   root_pairs  : (基準面, 基準辺) ペアのリスト
+//   new_index   : 結合後のファイルの索引を格納する参照
+//
+// Output:
+//   Returns true on success, false on failure (with an error on std::cerr).
+//
+// 出力:
+//   成功時は true、失敗時は false を返す（std::cerr にエラーを出力）。
+//
+// Guarantee:
+//   - Replaces the records of every root in subset with the re-run records
+//     and keeps all other ranges byte for byte, so the result equals a full
+//     run with the same options
+//   - Writes to a uniquely named temporary file next to out_path and
+//     renames it over out_path; on failure out_path is unchanged
+//
+// 保証:
+//   - subset に含まれる各 root のレコードを再実行のレコードで置き換え、
+//     その他の範囲はバイト単位でそのまま保つため、結果は同じオプションでの
+//     全体実行と一致する
+//   - out_path の隣の一意な名前の一時ファイルに書き込んでから out_path に
+//     リネームする。失敗時は out_path は変更されない
+//
+// ----------------------------------------------------------------------------
+bool spliceSubset(const std::string& out_path,
+                  const OutputIndex& old_index,
+                  const std::vector<int>& subset,
+                  const std::string& subset_path,
+                  const std::vector<std::pair<int, int>>& root_pairs,
+                  OutputIndex& new_index) {
+    MappedFile old_file, subset_file;
+    if (!old_file.open(out_path) || !subset_file.open(subset_path)) {
+        std::cerr << "Error: Cannot read files to splice\n";
+        return false;
+    }
+    if (old_file.size() != static_cast<size_t>(old_index.num_bytes)) {
+        std::cerr << "Error: " << out_path << " changed during the run\n";
+        return false;
+    }
+
+    std::vector<std::pair<int, int>> subset_pairs;
+    for (int r : subset) {
+        subset_pairs.push_back(root_pairs[r]);
+    }
+    OutputIndex subset_index;
+    if (!subset_index.scan(subset_file.data(), subset_file.size(), subset_pairs)) {
+        return false;
+    }
+
+    std::string tmp_path;
+    if (!createTempFile(out_path, tmp_path)) {
+        return false;
+    }
+    std::ofstream out(tmp_path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Error: Cannot open output file: " << tmp_path << "\n";
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    new_index = OutputIndex();
+    size_t next = 0;
+    for (size_t r = 0; r < root_pairs.size(); ++r) {
+        const char* data = old_file.data();
+        RootRange range = old_index.roots[r];
+        if (next < subset.size() && subset[next] == static_cast<int>(r)) {
+            data = subset_file.data();
+            range = subset_index.roots[next++];
+        }
+        if (range.num_bytes > 0) {
+            out.write(data + range.offset, static_cast<std::streamsize>(range.num_bytes));
+            new_index.checksum = HashUtil::fnv1a64(data + range.offset,
+                                                   static_cast<size_t>(range.num_bytes),
+                                                   new_index.checksum);
+        }
+        range.offset = new_index.num_bytes;
+        new_index.roots.push_back(range);
+        new_index.num_bytes += range.num_bytes;
+    }
+
+    out.close();
+    if (!out || std::rename(tmp_path.c_str(), out_path.c_str()) != 0) {
+        std::cerr << "Error: Cannot write output file: " << out_path << "\n";
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
 // ============================================================================
 // Main Entry Point
 // ============================================================================
@@ -197,14 +779,29 @@ CliArgs parseArgs(int argc, char* argv[]) {
 //   - Loads polyhedron data from polyhedron.json and root_pairs.json
 //   - Executes rotational unfolding for all root pairs
 //   - Outputs JSONL records for all candidate partial unfoldings
+//     in root-pair order, independent of the number of threads
 //   - Flushes output after each root pair for safety
+//   - In the top-K mode, instead outputs only the K candidates with the
+//     smallest endpoint slack, in ranking order, independent of the
+//     number of threads
+//   - With --roots-subset, re-runs only the selected root pairs and splices
+//     their records into the existing --out file, identical to a full run
+//   - Writes the byte-offset index of --out (if --index is given)
+//   - Updates the cost model (if given) with the measured per-root costs
 //
 // 保証:
 //   - CLI引数を解析
 //   - polyhedron.json および root_pairs.json から多面体データを読み込み
 //   - すべての root pair について回転展開を実行
-//   - すべての候補部分展開図についてJSONLレコードを出力
+//   - すべての候補部分展開図についてJSONLレコードを
+//     スレッド数によらず root pair の順に出力
 //   - 安全のために各 root pair 後に出力をフラッシュ
+//   - top-K モードでは代わりに、端点スラックが最も小さい K 個の候補のみを
+//     スレッド数によらず順位順に出力
+//   - --roots-subset 指定時は、選択された root pair のみを再実行し、そのレコードを
+//     既存の --out ファイルに結合する（全体実行と一致する）
+//   - （--index が指定された場合）--out のバイトオフセット索引を書き込む
+//   - （指定された場合）計測した root pair ごとのコストでコストモデルを更新
 //
 // ----------------------------------------------------------------------------
 int main(int argc, char* argv[]) {
@@ -236,6 +833,27 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    // ------------------------------------------------------------------------
+    // Select the root pairs to run (all, or a subset to splice)
+    // 実行する root pair を選択（すべて、または結合する一部）
+    // ------------------------------------------------------------------------
+    std::vector<int> subset;
+    std::vector<std::pair<int, int>> search_pairs = root_pairs;
+    OutputIndex old_index;
+    std::string subset_path;
+    if (!args.roots_subset.empty()) {
+        if (!parseRootsSubset(args.roots_subset, root_pairs, subset) ||
+            !loadExistingIndex(args.out_path, args.index_path, root_pairs, old_index)) {
+            return 1;
+        }
+        search_pairs.clear();
+        for (int r : subset) {
+            search_pairs.push_back(root_pairs[r]);
+        }
+        std::cerr << "Info: Re-running " << subset.size() << " of " << root_pairs.size()
+                  << " root pairs to splice into " << args.out_path << "\n";
+    }
+
     // ------------------------------------------------------------------------
     // Determine symmetry setting
     // 対称性設定を決定
@@ -269,45 +887,261 @@ int main(int argc, char* argv[]) {
     // ------------------------------------------------------------------------
     std::ofstream out_file;
     std::ostream* output = &std::cout;
+    ShmRing ring;
+    std::unique_ptr<ShmRingWriter> ring_writer;
+    std::ostream ring_output(nullptr);
+
+    // Set when the output can no longer be delivered, so the search ends early
+    // 出力をもう届けられなくなったときに設定し、探索を早期に終了させる
+    std::atomic<bool> stop_search{false};
+    args.search_options.stop = &stop_search;
 
-    if (!args.out_path.empty()) {
-        out_file.open(args.out_path);
+    if (!args.shm_ring.empty()) {
+        if (!ring.attach(args.shm_ring)) {
+            return 1;
+        }
+        ring_writer = std::make_unique<ShmRingWriter>(ring, &stop_search);
+        ring_output.rdbuf(ring_writer.get());
+        output = &ring_output;
+        std::cerr << "Info: Writing binary records to the shared-memory ring ("
+                  << ring.capacity() << " bytes)\n";
+    }
+    else if (!args.out_dir.empty()) {
+        // Remove the manifest and task files of a previous run first, so that
+        // an interrupted run never leaves a manifest describing files it did
+        // not write, and old task files never mix with new ones
+        // 中断した実行が書いていないファイルを記述するマニフェストを残さず、
+        // 古いタスクファイルが新しいものと混ざらないよう、以前の実行の
+        // マニフェストとタスクファイルを先に削除する
+        std::error_code ec;
+        std::filesystem::create_directories(args.out_dir, ec);
+        if (!std::filesystem::is_directory(args.out_dir)) {
+            std::cerr << "Error: Cannot create output directory: " << args.out_dir << "\n";
+            return 1;
+        }
+        if (!OutputManifest::removeTaskFiles(args.out_dir)) {
+            return 1;
+        }
+        std::cerr << "Info: Writing per-task output to: " << args.out_dir << "\n";
+    }
+    else if (!args.out_path.empty()) {
+        // A subset run writes next to the existing file, which is spliced later
+        // 一部の実行は既存ファイルの隣に書き込み、後で結合する
+        if (!subset.empty() && !createTempFile(args.out_path, subset_path)) {
+            return 1;
+        }
+        const std::string& path = subset.empty() ? args.out_path : subset_path;
+        out_file.open(path);
         if (!out_file) {
-            std::cerr << "Error: Cannot open output file: " << args.out_path << "\n";
+            std::cerr << "Error: Cannot open output file: " << path << "\n";
+            if (!subset_path.empty()) std::remove(subset_path.c_str());
             return 1;
         }
         output = &out_file;
-        std::cerr << "Info: Writing output to: " << args.out_path << "\n";
+        std::cerr << "Info: Writing output to: " << path << "\n";
     }
     else {
         std::cerr << "Info: Writing output to stdout\n";
     }
 
+    if (args.search_options.emit_buffer != GeometryUtil::buffer) {
+        std::cerr << "Info: Emit buffer: " << args.search_options.emit_buffer << "\n";
+    }
+    if (args.search_options.tag_slack) {
+        std::cerr << "Info: Tagging records with endpoint slack\n";
+    }
+    if (args.top_k > 0) {
+        std::cerr << "Info: Mode: topk (keeping the " << args.top_k
+                  << " candidates with the smallest endpoint slack)\n";
+    }
+
+    // ------------------------------------------------------------------------
+    // Determine the number of worker threads
+    // ワーカースレッド数を決定
+    // ------------------------------------------------------------------------
+    int threads = args.num_threads;
+    if (threads == 0) {
+        threads = CpuTopology::defaultThreadCount();
+    }
+    std::cerr << "Info: Threads: " << threads << (args.pin_threads ? " (pinned)" : "") << "\n";
+
+    ParallelRunner runner(poly, symmetric, args.search_options, threads, args.pin_threads);
+
+    // ------------------------------------------------------------------------
+    // Estimate per-root costs from the cost model, or by probing
+    // コストモデルまたはプローブにより root pair ごとのコストを見積もる
+    // ------------------------------------------------------------------------
+    std::string cost_key;
+    std::map<std::pair<int, int>, CostModel::RootCost> history;
+    if (!args.cost_model_path.empty()) {
+        if (CostModel::makeKey(args.polyhedron_path, symmetric, args.search_options, cost_key)) {
+            // The top-K mode prunes differently, so its costs are kept apart
+            // top-K モードは枝刈りが異なるため、そのコストは別に保持する
+            if (args.top_k > 0) {
+                cost_key += "/topk=" + std::to_string(args.top_k);
+            }
+            CostModel::loadRootCosts(args.cost_model_path, cost_key, history);
+        } else {
+            std::cerr << "Warning: Cannot compute cost-model key; cost model disabled\n";
+            args.cost_model_path.clear();
+        }
+    }
+
+    std::vector<double> root_costs = estimateRootCosts(runner, search_pairs, history, threads);
+
+    std::vector<SearchTask> tasks = runner.planTasks(search_pairs, root_costs);
+    std::vector<int> schedule = runner.scheduleTasks(tasks);
+
     // ------------------------------------------------------------------------
     // Execute rotational unfolding for all root pairs
     // すべての root pairs について回転展開を実行
     // ------------------------------------------------------------------------
-    const int total = root_pairs.size();
-    std::cerr << "Info: Processing " << total << " root pairs...\n";
+    const int total = search_pairs.size();
+    std::cerr << "Info: Processing " << total << " root pairs ("
+              << tasks.size() << " tasks)...\n";
 
-    for (int current = 0; current < total; ++current) {
-        const auto& [face, edge] = root_pairs[current];
+    auto start = std::chrono::steady_clock::now();
+    std::vector<TaskStats> stats;
+    std::unique_ptr<ShmRingWatcher> ring_watcher;
+    if (ring_writer) {
+        ring_watcher = std::make_unique<ShmRingWatcher>(ring, stop_search);
+    }
+    if (args.top_k > 0) {
+        // Top-K mode: collect the tightest candidates, then write them in
+        // ranking order, each tagged with its endpoint slack
+        // top-K モード: 最も厳しい候補を収集し、順位順に端点スラック付きで書き込む
+        std::vector<TopKCandidate> best;
+        stats = runner.runTopK(tasks, schedule, static_cast<size_t>(args.top_k), best);
+        for (const auto& candidate : best) {
+            EndpointSlack slack = {candidate.circle_gap};
+            if (args.search_options.binary_records) {
+                BinaryRecord::writeRecord(*output, candidate.base_face, candidate.base_edge,
+                                          symmetric, candidate.faces, &slack);
+            } else {
+                JsonUtil::writeJsonlRecord(*output, candidate.base_face, candidate.base_edge,
+                                           symmetric, candidate.faces, &slack);
+            }
+        }
+        output->flush();
+        std::cerr << "Info: Wrote " << best.size() << " top-K candidates\n";
+    } else if (!args.out_dir.empty()) {
+        // Per-task mode: every task writes its own file concurrently; the
+        // manifest records the canonical order for concatenation
+        // タスクごとのモード: 各タスクが自身のファイルに並行して書き込み、
+        // マニフェストが連結のための正規の順序を記録する
+        std::vector<TaskFile> files;
+        stats = runner.runToFiles(tasks, schedule, args.out_dir, files);
+        if (stats.empty() && !tasks.empty()) {
+            return 1;
+        }
+        std::string manifest_path = args.out_dir + "/" + OutputManifest::MANIFEST_NAME;
+        if (!OutputManifest::writeManifest(manifest_path, symmetric, files)) {
+            return 1;
+        }
+        std::cerr << "Info: Wrote " << files.size() << " task files and " << manifest_path << "\n";
+    } else {
+        std::error_code ec;
+        std::string spill_dir = std::filesystem::temp_directory_path(ec).string();
+        if (ec) spill_dir = "/tmp";
+        stats = runner.run(tasks, schedule, total, *output, args.reorder_mem_cap, spill_dir);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    ring_watcher.reset();
 
-        // Report progress every 10 pairs, and always report first and last
-        // 10ペアごとに進捗を報告し、最初と最後は必ず報告
-        if ((current + 1) % 10 == 0 || current == 0 || current == total - 1) {
-            std::cerr << "Info: Processing " << (current + 1) << "/" << total << "\n";
+    // Mark the end of the ring, so the consumer sees a complete stream
+    // (a stopped search wrote an incomplete one)
+    // 読み手が完全なストリームを受け取れるよう、リングの終わりを示す
+    // （打ち切られた探索が書いたストリームは不完全）
+    if (ring_writer) {
+        ring_output.flush();
+        if (!ring_writer->close(ring_output.good() && !stop_search)) {
+            std::cerr << "Error: "
+                      << (ring_writer->consumerClosed() ? "Ring consumer stopped reading"
+                                                        : "Cannot write to the shared-memory ring")
+                      << "\n";
+            return 1;
         }
+    }
 
-        RotationalUnfolding rot_ufd(poly, face, edge, symmetric, symmetric);
-        rot_ufd.runRotationalUnfolding(*output);
+    // Check the output on every path, so that a failed write never exits 0
+    // 書き込みに失敗した実行が 0 で終了しないよう、すべての経路で出力を確認する
+    output->flush();
+    if (out_file.is_open()) {
+        out_file.close();
+    }
+    if ((stats.empty() && !tasks.empty()) || !output->good() || stop_search) {
+        std::cerr << "Error: Cannot write output\n";
+        if (!subset_path.empty()) std::remove(subset_path.c_str());
+        return 1;
+    }
 
-        // Flush output after each root pair for safety
-        // 安全のために各 root pair 後に出力をフラッシュ
-        output->flush();
+    std::cerr << "Info: Done. Processed " << total << " root pairs in "
+              << elapsed.count() << " s.\n";
+
+    // ------------------------------------------------------------------------
+    // Splice the subset into the existing output, and write the index
+    // 一部の出力を既存の出力に結合し、索引を書き込む
+    // ------------------------------------------------------------------------
+    if (!args.index_path.empty()) {
+        OutputIndex index;
+        if (!subset.empty()) {
+            bool spliced = spliceSubset(args.out_path, old_index, subset, subset_path,
+                                        root_pairs, index);
+            std::remove(subset_path.c_str());
+            if (!spliced) {
+                return 1;
+            }
+            std::cerr << "Info: Spliced " << subset.size() << " root pairs into "
+                      << args.out_path << "\n";
+        } else {
+            MappedFile file;
+            if (!file.open(args.out_path) || !index.scan(file.data(), file.size(), root_pairs)) {
+                std::cerr << "Error: Cannot index " << args.out_path << "\n";
+                return 1;
+            }
+        }
+
+        if (!index.save(args.index_path)) {
+            return 1;
+        }
+        std::cerr << "Info: Index written to: " << args.index_path << "\n";
     }
 
-    std::cerr << "Info: Done. Processed " << total << " root pairs.\n";
+    // ------------------------------------------------------------------------
+    // Record the measured per-root costs in the cost model
+    // 計測した root pair ごとのコストをコストモデルに記録
+    // ------------------------------------------------------------------------
+    if (!args.cost_model_path.empty()) {
+        std::vector<CostModel::RootCost> measured;
+        for (const auto& [face, edge] : search_pairs) {
+            measured.push_back({face, edge, 0, 0.0});
+        }
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            measured[tasks[i].root_index].nodes += stats[i].nodes;
+            measured[tasks[i].root_index].seconds += stats[i].seconds;
+        }
+
+        // A subset run keeps the recorded costs of the other root pairs
+        // 一部の実行では、その他の root pair の記録済みコストを保持する
+        if (!subset.empty()) {
+            std::vector<CostModel::RootCost> merged;
+            size_t next = 0;
+            for (size_t r = 0; r < root_pairs.size(); ++r) {
+                if (next < subset.size() && subset[next] == static_cast<int>(r)) {
+                    merged.push_back(measured[next++]);
+                } else {
+                    auto it = history.find(root_pairs[r]);
+                    if (it != history.end()) merged.push_back(it->second);
+                }
+            }
+            measured.swap(merged);
+        }
+
+        std::string poly_name = IOUtil::extractPolyNameFromJson(args.polyhedron_path);
+        if (CostModel::saveRootCosts(args.cost_model_path, cost_key, poly_name, measured)) {
+            std::cerr << "Info: Cost model updated: " << args.cost_model_path << "\n";
+        }
+    }
 
     return 0;
 }
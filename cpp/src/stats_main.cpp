@@ -0,0 +1,709 @@
+// ============================================================================
+// stats_main.cpp
+// ============================================================================
+//
+// What this file does:
+//   CLI entry point for rotunfold-stats, a native tool that summarizes
+//   partial unfolding JSONL files, compares two of them as multisets, and
+//   concatenates per-task output directories.
+//
+// このファイルの役割:
+//   部分展開図の JSONL ファイルを集計し、2つのファイルを多重集合として比較し、
+//   タスクごとの出力ディレクトリを連結するネイティブツール rotunfold-stats の
+//   CLI 入口点。
+//
+// Responsibility in the project:
+//   - summary: counts records per root pair, the path-length distribution,
+//     and the gon composition of one or more files
+//   - diff: order-insensitive multiset diff of two files by record hash,
+//     reporting added and removed records with their base pairs
+//   - concat: joins the files of a per-task output directory in manifest
+//     order, verifying their sizes and checksums
+//   - Processes each file in parallel, line-aligned chunks
+//   - Does NOT modify any input file
+//
+// プロジェクト内での責務:
+//   - summary: 1つ以上のファイルについて、root pair ごとのレコード数、
+//     パス長の分布、角数の構成を集計
+//   - diff: レコードのハッシュによる、順序に依存しない2ファイルの多重集合差分。
+//     追加・削除されたレコードを基準ペアとともに報告
+//   - concat: タスクごとの出力ディレクトリのファイルをマニフェストの順に連結し、
+//     サイズとチェックサムを検証
+//   - 各ファイルを行境界で揃えたチャンク単位で並列に処理
+//   - 入力ファイルの変更は行わない
+//
+// Phase 1 における位置づけ:
+//   Inspection tool for pipeline outputs (raw.jsonl, noniso.jsonl,
+//   exact.jsonl), e.g., to compare the outputs of two engine versions or to
+//   summarize a whole catalog.
+//   Phase 1では、パイプライン出力（raw.jsonl, noniso.jsonl, exact.jsonl）の
+//   検査ツール。例えば2つのエンジンのバージョンの出力比較や、カタログ全体の
+//   集計に使用する。
+//
+// Output format (stdout, JSONL):
+//   summary: one {"record_type": "summary", ...} record per input file
+//   diff:    one {"record_type": "diff_summary", ...} record followed by one
+//            {"record_type": "diff_entry", ...} record per unmatched record
+//   concat:  the concatenated JSONL records (stdout or --out)
+//
+// ============================================================================
+
+#include "RecordReader.hpp"
+#include "OutputManifest.hpp"
+#include "CpuTopology.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using json = nlohmann::ordered_json;
+
+// ============================================================================
+// CLI Argument Parsing
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// CliArgs
+// ----------------------------------------------------------------------------
+//
+// Represents parsed command-line arguments.
+// コマンドライン引数の解析結果を表す。
+//
+// ----------------------------------------------------------------------------
+struct CliArgs {
+    std::string command;             // "summary", "diff", or "concat"
+    std::vector<std::string> paths;  // Input files
+    int num_threads = 0;             // Number of threads (0 = CPUs available to the process)
+    long long limit = 0;             // Maximum diff entries to list (0 = all)
+    std::string out_path;            // concat output file (empty = stdout)
+
+    bool valid = false;              // Whether parsing succeeded
+};
+
+// ----------------------------------------------------------------------------
+// printUsage
+// ----------------------------------------------------------------------------
+//
+// Prints usage information to stderr.
+// 使用方法を stderr に出力する。
+//
+// ----------------------------------------------------------------------------
+void printUsage(const char* program_name) {
+    std::cerr << "Usage: " << program_name << " summary FILE... [--threads N]\n";
+    std::cerr << "       " << program_name << " diff FILE_A FILE_B [--threads N] [--limit N]\n";
+    std::cerr << "       " << program_name << " concat MANIFEST [--out PATH]\n";
+    std::cerr << "\n";
+    std::cerr << "Commands:\n";
+    std::cerr << "  summary             Records per root pair, path lengths, and gon composition\n";
+    std::cerr << "  diff                Order-insensitive diff of two files (exit 0: same, 1: differ)\n";
+    std::cerr << "  concat              Join the files of a rotunfold --out-dir manifest in canonical order\n";
+    std::cerr << "\n";
+    std::cerr << "Options:\n";
+    std::cerr << "  --threads N         Number of threads (default: CPUs available)\n";
+    std::cerr << "  --limit N           Maximum number of diff entries to list (default: all)\n";
+    std::cerr << "  --out PATH          concat output file (default: stdout)\n";
+    std::cerr << "\n";
+    std::cerr << "Input: partial unfolding JSONL (raw.jsonl, noniso.jsonl, or exact.jsonl)\n";
+}
+
+// ----------------------------------------------------------------------------
+// parseArgs
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   argc : Argument count
+//   argv : Argument vector
+//
+// 入力:
+//   argc : 引数の数
+//   argv : 引数のベクター
+//
+// Output:
+//   Returns a CliArgs structure with parsed arguments.
+//   If parsing fails, CliArgs.valid is false.
+//
+// 出力:
+//   解析された引数を含む CliArgs 構造体を返す。
+//   解析が失敗した場合、CliArgs.valid は false。
+//
+// Guarantee:
+//   - Validates the command and the number of input files
+//   - Validates --threads is a positive integer and --limit is non-negative
+//   - Writes error messages to stderr on failure
+//
+// 保証:
+//   - コマンドと入力ファイル数を検証
+//   - --threads が正の整数、--limit が非負であることを検証
+//   - 失敗時に stderr にエラーメッセージを書き込み
+//
+// ----------------------------------------------------------------------------
+CliArgs parseArgs(int argc, char* argv[]) {
+    CliArgs args;
+    if (argc < 2) {
+        return args;
+    }
+    args.command = argv[1];
+    if (args.command != "summary" && args.command != "diff" && args.command != "concat") {
+        std::cerr << "Error: Unknown command: " << args.command << "\n";
+        return args;
+    }
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--threads" && i + 1 < argc) {
+            try {
+                args.num_threads = std::stoi(argv[++i]);
+            } catch (...) {
+                args.num_threads = -1;
+            }
+            if (args.num_threads < 1) {
+                std::cerr << "Error: --threads must be a positive integer\n";
+                return args;
+            }
+        }
+        else if (arg == "--limit" && i + 1 < argc) {
+            try {
+                args.limit = std::stoll(argv[++i]);
+            } catch (...) {
+                args.limit = -1;
+            }
+            if (args.limit < 0) {
+                std::cerr << "Error: --limit must be a non-negative integer\n";
+                return args;
+            }
+        }
+        else if (arg == "--out" && i + 1 < argc) {
+            args.out_path = argv[++i];
+        }
+        else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Error: Unknown argument: " << arg << "\n";
+            return args;
+        }
+        else {
+            args.paths.push_back(arg);
+        }
+    }
+
+    if (args.command == "summary" && args.paths.empty()) {
+        std::cerr << "Error: summary requires at least one file\n";
+        return args;
+    }
+    if (args.command == "diff" && args.paths.size() != 2) {
+        std::cerr << "Error: diff requires exactly two files\n";
+        return args;
+    }
+    if (args.command == "concat" && args.paths.size() != 1) {
+        std::cerr << "Error: concat requires exactly one manifest\n";
+        return args;
+    }
+
+    if (args.num_threads == 0) {
+        args.num_threads = CpuTopology::defaultThreadCount();
+    }
+
+    args.valid = true;
+    return args;
+}
+
+// ============================================================================
+// summary
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// FileSummary
+// ----------------------------------------------------------------------------
+//
+// Aggregated statistics of one file (or one chunk of a file).
+// 1つのファイル（またはファイルの1チャンク）の集計統計。
+//
+// ----------------------------------------------------------------------------
+struct FileSummary {
+    long long num_records = 0;                          // Valid records
+    long long num_invalid = 0;                          // Lines that failed to parse
+    long long num_faces = 0;                            // Faces over all records
+    std::map<std::pair<int, int>, long long> per_root;  // (base_face, base_edge) -> records
+    std::map<int, long long> per_length;                // Number of faces -> records
+    std::map<int, long long> per_gon;                   // Gon -> faces
+
+    void merge(const FileSummary& other) {
+        num_records += other.num_records;
+        num_invalid += other.num_invalid;
+        num_faces += other.num_faces;
+        for (const auto& kv : other.per_root) per_root[kv.first] += kv.second;
+        for (const auto& kv : other.per_length) per_length[kv.first] += kv.second;
+        for (const auto& kv : other.per_gon) per_gon[kv.first] += kv.second;
+    }
+};
+
+// ----------------------------------------------------------------------------
+// summarizeFile
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   path        : Path to a JSONL file
+//   num_threads : Number of chunks processed in parallel
+//   summary     : Reference to store the result
+//
+// 入力:
+//   path        : JSONL ファイルへのパス
+//   num_threads : 並列に処理するチャンク数
+//   summary     : 結果を格納する参照
+//
+// Output:
+//   Returns true on success, false if the file cannot be opened.
+//
+// 出力:
+//   成功時は true、ファイルを開けない場合は false を返す。
+//
+// ----------------------------------------------------------------------------
+bool summarizeFile(const std::string& path, int num_threads, FileSummary& summary) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Error: Cannot open file: " << path << "\n";
+        return false;
+    }
+
+    const char* data = file.data();
+    std::vector<RecordReader::Chunk> chunks =
+        RecordReader::splitIntoChunks(data, file.size(), num_threads);
+    std::vector<FileSummary> partial(chunks.size());
+
+    RecordReader::forEachChunkParallel(chunks, [&](size_t c, const RecordReader::Chunk& chunk) {
+        FileSummary& s = partial[c];
+        ParsedRecord record;
+        RecordReader::forEachLine(data, chunk, [&](const char* line, size_t len) {
+            if (!RecordReader::parseRecord(line, len, record)) {
+                ++s.num_invalid;
+                return;
+            }
+            ++s.num_records;
+            s.num_faces += static_cast<long long>(record.faces.size());
+            ++s.per_root[{record.base_face, record.base_edge}];
+            ++s.per_length[static_cast<int>(record.faces.size())];
+            for (const auto& face : record.faces) {
+                ++s.per_gon[face.gon];
+            }
+        });
+    });
+
+    for (const auto& s : partial) {
+        summary.merge(s);
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// runSummary
+// ----------------------------------------------------------------------------
+//
+// Writes one summary record per input file to stdout.
+// Returns 0 on success, 1 if any file cannot be read.
+//
+// 入力ファイルごとに1つの集計レコードを stdout に書き込む。
+// 成功時は 0、読めないファイルがあれば 1 を返す。
+//
+// ----------------------------------------------------------------------------
+int runSummary(const CliArgs& args) {
+    int status = 0;
+    for (const auto& path : args.paths) {
+        FileSummary s;
+        if (!summarizeFile(path, args.num_threads, s)) {
+            status = 1;
+            continue;
+        }
+        if (s.num_invalid > 0) {
+            std::cerr << "Warning: " << path << ": " << s.num_invalid
+                      << " line(s) are not partial unfolding records\n";
+        }
+
+        json roots = json::array();
+        for (const auto& kv : s.per_root) {
+            roots.push_back({
+                {"base_face", kv.first.first},
+                {"base_edge", kv.first.second},
+                {"records", kv.second}
+            });
+        }
+        json lengths = json::object();
+        for (const auto& kv : s.per_length) {
+            lengths[std::to_string(kv.first)] = kv.second;
+        }
+        json gons = json::object();
+        for (const auto& kv : s.per_gon) {
+            gons[std::to_string(kv.first)] = kv.second;
+        }
+
+        json out = {
+            {"record_type", "summary"},
+            {"path", path},
+            {"num_records", s.num_records},
+            {"num_invalid", s.num_invalid},
+            {"num_faces", s.num_faces},
+            {"records_per_root", roots},
+            {"records_per_length", lengths},
+            {"faces_per_gon", gons}
+        };
+        std::cout << out.dump() << "\n";
+    }
+    return status;
+}
+
+// ============================================================================
+// diff
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// RecordKey
+// ----------------------------------------------------------------------------
+//
+// Hash and location of one record, used for the multiset diff.
+// 多重集合差分に使用する、1つのレコードのハッシュと位置。
+//
+// ----------------------------------------------------------------------------
+struct RecordKey {
+    std::uint64_t hash;   // RecordReader::hashRecord
+    long long line;       // 1-based record number in the file
+    int base_face;        // base_pair.base_face
+    int base_edge;        // base_pair.base_edge
+};
+
+// ----------------------------------------------------------------------------
+// hashFileRecords
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   path        : Path to a JSONL file
+//   num_threads : Number of chunks processed in parallel
+//   keys        : Reference to store one RecordKey per valid record
+//
+// 入力:
+//   path        : JSONL ファイルへのパス
+//   num_threads : 並列に処理するチャンク数
+//   keys        : 有効なレコードごとに1つの RecordKey を格納する参照
+//
+// Output:
+//   Returns true on success, false if the file cannot be opened or contains
+//   a line that is not a partial unfolding record.
+//
+// 出力:
+//   成功時は true、ファイルを開けない場合や部分展開図レコードでない行を
+//   含む場合は false を返す。
+//
+// Guarantee:
+//   - keys is sorted by (hash, line)
+//
+// 保証:
+//   - keys は (hash, line) の順にソートされる
+//
+// ----------------------------------------------------------------------------
+bool hashFileRecords(const std::string& path, int num_threads, std::vector<RecordKey>& keys) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Error: Cannot open file: " << path << "\n";
+        return false;
+    }
+
+    const char* data = file.data();
+    std::vector<RecordReader::Chunk> chunks =
+        RecordReader::splitIntoChunks(data, file.size(), num_threads);
+    std::vector<std::vector<RecordKey>> partial(chunks.size());
+    std::vector<long long> counts(chunks.size(), 0);
+    std::vector<long long> invalid(chunks.size(), -1);
+
+    RecordReader::forEachChunkParallel(chunks, [&](size_t c, const RecordReader::Chunk& chunk) {
+        ParsedRecord record;
+        long long line = 0;
+        RecordReader::forEachLine(data, chunk, [&](const char* text, size_t len) {
+            ++line;
+            if (!RecordReader::parseRecord(text, len, record)) {
+                if (invalid[c] < 0) invalid[c] = line;
+                return;
+            }
+            partial[c].push_back({RecordReader::hashRecord(record), line,
+                                  record.base_face, record.base_edge});
+        });
+        counts[c] = line;
+        std::sort(partial[c].begin(), partial[c].end(),
+                  [](const RecordKey& a, const RecordKey& b) {
+                      return a.hash != b.hash ? a.hash < b.hash : a.line < b.line;
+                  });
+    });
+
+    // Convert chunk-local record numbers to file-wide record numbers
+    // チャンク内のレコード番号をファイル全体のレコード番号に変換
+    long long offset = 0;
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        if (invalid[c] >= 0) {
+            std::cerr << "Error: " << path << ": record " << offset + invalid[c]
+                      << " is not a partial unfolding record\n";
+            return false;
+        }
+        for (auto& key : partial[c]) key.line += offset;
+        offset += counts[c];
+    }
+
+    keys.clear();
+    keys.reserve(static_cast<size_t>(offset));
+    for (const auto& part : partial) {
+        std::vector<RecordKey> merged;
+        merged.reserve(keys.size() + part.size());
+        std::merge(keys.begin(), keys.end(), part.begin(), part.end(), std::back_inserter(merged),
+                   [](const RecordKey& a, const RecordKey& b) {
+                       return a.hash != b.hash ? a.hash < b.hash : a.line < b.line;
+                   });
+        keys.swap(merged);
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// runDiff
+// ----------------------------------------------------------------------------
+//
+// Compares two files as multisets of records.
+// Writes a diff_summary record followed by one diff_entry record per record
+// that occurs more often in one file than in the other, in file order
+// (removed records of A first, then added records of B).
+// Returns 0 if the multisets are equal, 1 if they differ, 2 on error.
+//
+// 2つのファイルをレコードの多重集合として比較する。
+// diff_summary レコードに続けて、一方のファイルにより多く現れるレコードごとに
+// diff_entry レコードをファイル順に書き込む（A の削除レコードを先に、
+// 次に B の追加レコード）。
+// 多重集合が等しければ 0、異なれば 1、エラー時は 2 を返す。
+//
+// ----------------------------------------------------------------------------
+int runDiff(const CliArgs& args) {
+    std::vector<RecordKey> a, b;
+    if (!hashFileRecords(args.paths[0], args.num_threads, a) ||
+        !hashFileRecords(args.paths[1], args.num_threads, b)) {
+        return 2;
+    }
+
+    std::vector<RecordKey> removed, added;
+    size_t i = 0, j = 0;
+    while (i < a.size() || j < b.size()) {
+        if (j == b.size() || (i < a.size() && a[i].hash < b[j].hash)) {
+            removed.push_back(a[i++]);
+        } else if (i == a.size() || b[j].hash < a[i].hash) {
+            added.push_back(b[j++]);
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+
+    auto by_line = [](const RecordKey& x, const RecordKey& y) { return x.line < y.line; };
+    std::sort(removed.begin(), removed.end(), by_line);
+    std::sort(added.begin(), added.end(), by_line);
+
+    json summary = {
+        {"record_type", "diff_summary"},
+        {"path_a", args.paths[0]},
+        {"path_b", args.paths[1]},
+        {"num_records_a", a.size()},
+        {"num_records_b", b.size()},
+        {"num_common", a.size() - removed.size()},
+        {"num_removed", removed.size()},
+        {"num_added", added.size()}
+    };
+    std::cout << summary.dump() << "\n";
+
+    long long listed = 0;
+    auto write_entries = [&](const std::vector<RecordKey>& keys, const char* change) {
+        for (const auto& key : keys) {
+            if (args.limit > 0 && listed >= args.limit) return;
+            json entry = {
+                {"record_type", "diff_entry"},
+                {"change", change},
+                {"line", key.line},
+                {"base_pair", {{"base_face", key.base_face}, {"base_edge", key.base_edge}}}
+            };
+            std::cout << entry.dump() << "\n";
+            ++listed;
+        }
+    };
+    write_entries(removed, "removed");
+    write_entries(added, "added");
+
+    return (removed.empty() && added.empty()) ? 0 : 1;
+}
+
+// ============================================================================
+// concat
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// copyTaskFile
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   path : Path of the task file
+//   file : Manifest entry of the task file
+//   out  : Output stream
+//
+// 入力:
+//   path : タスクファイルのパス
+//   file : タスクファイルのマニフェストエントリ
+//   out  : 出力ストリーム
+//
+// Output:
+//   Returns true if the file was copied and its size and FNV-1a checksum
+//   match the manifest; false otherwise (with an error on std::cerr).
+//
+// 出力:
+//   ファイルをコピーでき、サイズと FNV-1a チェックサムがマニフェストと一致すれば
+//   true、そうでなければ false を返す（std::cerr にエラーを出力）。
+//
+// ----------------------------------------------------------------------------
+bool copyTaskFile(const std::string& path, const TaskFile& file, std::ostream& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Error: Cannot open task file: " << path << "\n";
+        return false;
+    }
+
+    std::vector<char> buffer(1 << 16);
+    long long num_bytes = 0;
+    std::uint64_t hash = HashUtil::FNV_OFFSET_BASIS;
+    while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::size_t n = static_cast<std::size_t>(in.gcount());
+        if (n == 0) break;
+        hash = HashUtil::fnv1a64(buffer.data(), n, hash);
+        num_bytes += static_cast<long long>(n);
+        out.write(buffer.data(), static_cast<std::streamsize>(n));
+    }
+
+    if (num_bytes != file.num_bytes || hash != file.checksum) {
+        std::cerr << "Error: Task file does not match the manifest: " << path
+                  << " (" << num_bytes << " bytes, fnv1a64 " << HashUtil::toHex(hash)
+                  << "; expected " << file.num_bytes << " bytes, fnv1a64 "
+                  << HashUtil::toHex(file.checksum) << ")\n";
+        return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// runConcat
+// ----------------------------------------------------------------------------
+//
+// Writes the task files listed in a manifest, in manifest (canonical) order,
+// to --out or stdout. The result is byte-identical to the single-stream
+// output of the same run. When --out is given, the output is written to a
+// temporary file and renamed only if every task file is verified.
+// Returns 0 on success, 1 on failure.
+//
+// マニフェストに列挙されたタスクファイルを、マニフェストの（正規の）順に
+// --out または stdout に書き込む。結果は同じ実行の単一ストリーム出力と
+// バイト単位で同一である。--out 指定時は一時ファイルに書き込み、すべての
+// タスクファイルを検証できた場合にのみリネームする。
+// 成功時は 0、失敗時は 1 を返す。
+//
+// ----------------------------------------------------------------------------
+int runConcat(const CliArgs& args) {
+    const std::string& manifest_path = args.paths[0];
+    std::vector<TaskFile> files;
+    if (!OutputManifest::loadManifest(manifest_path, files)) {
+        return 1;
+    }
+
+    std::string dir = ".";
+    size_t slash = manifest_path.find_last_of('/');
+    if (slash != std::string::npos) {
+        dir = manifest_path.substr(0, slash);
+    }
+
+    std::ofstream out_file;
+    std::ostream* output = &std::cout;
+    const std::string tmp_path = args.out_path + ".tmp";
+    if (!args.out_path.empty()) {
+        out_file.open(tmp_path, std::ios::binary);
+        if (!out_file) {
+            std::cerr << "Error: Cannot open output file: " << tmp_path << "\n";
+            return 1;
+        }
+        output = &out_file;
+    }
+
+    long long num_records = 0;
+    for (const auto& file : files) {
+        if (!copyTaskFile(dir + "/" + file.path, file, *output)) {
+            if (!args.out_path.empty()) {
+                out_file.close();
+                std::remove(tmp_path.c_str());
+            }
+            return 1;
+        }
+        num_records += file.num_records;
+    }
+    output->flush();
+
+    if (!args.out_path.empty()) {
+        out_file.close();
+        if (!out_file || std::rename(tmp_path.c_str(), args.out_path.c_str()) != 0) {
+            std::cerr << "Error: Cannot write output file: " << args.out_path << "\n";
+            std::remove(tmp_path.c_str());
+            return 1;
+        }
+    }
+    if (!*output) {
+        std::cerr << "Error: Cannot write output\n";
+        return 1;
+    }
+
+    std::cerr << "Info: Concatenated " << files.size() << " task files ("
+              << num_records << " records)\n";
+    return 0;
+}
+
+// ============================================================================
+// Main Entry Point
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// main
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   argc : Argument count
+//   argv : Argument vector
+//
+// 入力:
+//   argc : 引数の数
+//   argv : 引数のベクター
+//
+// Output:
+//   summary, concat: 0 on success, 1 on failure.
+//   diff:    0 if the files are equal as multisets, 1 if they differ,
+//            2 on failure.
+//
+// 出力:
+//   summary, concat: 成功時は 0、失敗時は 1。
+//   diff:    ファイルが多重集合として等しければ 0、異なれば 1、失敗時は 2。
+//
+// ----------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+    CliArgs args = parseArgs(argc, argv);
+    if (!args.valid) {
+        printUsage(argv[0]);
+        return (args.command == "diff") ? 2 : 1;
+    }
+
+    if (args.command == "summary") {
+        return runSummary(args);
+    }
+    if (args.command == "concat") {
+        return runConcat(args);
+    }
+    return runDiff(args);
+}
@@ -0,0 +1,365 @@
+// ============================================================================
+// validate_main.cpp
+// ============================================================================
+//
+// What this file does:
+//   CLI entry point for rotunfold-validate, a native tool that checks every
+//   record of a partial unfolding JSONL file by replaying its path on the
+//   polyhedron (see PathReplay).
+//
+// このファイルの役割:
+//   部分展開図の JSONL ファイルの各レコードを、そのパスを多面体上で再生する
+//   ことで検査するネイティブツール rotunfold-validate の CLI 入口点
+//   （PathReplay を参照）。
+//
+// Responsibility in the project:
+//   - Parses CLI arguments (--polyhedron, --threads, --tolerance, --limit)
+//   - Loads polyhedron data from JSON using IOUtil
+//   - Replays the records of each file in parallel, line-aligned chunks
+//   - Reports failed records and a per-file summary
+//   - Does NOT modify any input file
+//
+// プロジェクト内での責務:
+//   - CLI引数を解析（--polyhedron, --threads, --tolerance, --limit）
+//   - IOUtil を使用してJSONから多面体データを読み込み
+//   - 各ファイルのレコードを行境界で揃えたチャンク単位で並列に再生
+//   - 検査に失敗したレコードとファイルごとの集計を報告
+//   - 入力ファイルの変更は行わない
+//
+// Phase 1 における位置づけ:
+//   Gate for Phase 1 runs and for changes to the engine or output format.
+//   Phase 1では、実行結果およびエンジンや出力形式の変更を検証するゲート。
+//
+// Output format (stdout, JSONL):
+//   Per input file, one {"record_type": "validation_summary", ...} record
+//   followed by one {"record_type": "validation_error", ...} record per
+//   failed record, in file order.
+//
+// ============================================================================
+
+#include "PathReplay.hpp"
+#include "RecordReader.hpp"
+#include "IOUtil.hpp"
+#include "CpuTopology.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::ordered_json;
+
+// ============================================================================
+// CLI Argument Parsing
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// CliArgs
+// ----------------------------------------------------------------------------
+//
+// Represents parsed command-line arguments.
+// コマンドライン引数の解析結果を表す。
+//
+// ----------------------------------------------------------------------------
+struct CliArgs {
+    std::string polyhedron_path;     // Path to polyhedron.json
+    std::vector<std::string> paths;  // Input files
+    int num_threads = 0;             // Number of threads (0 = CPUs available to the process)
+    double tolerance = PathReplay::DEFAULT_TOLERANCE;  // Coordinate tolerance
+    long long limit = 0;             // Maximum errors to list per file (0 = all)
+
+    bool valid = false;              // Whether parsing succeeded
+};
+
+// ----------------------------------------------------------------------------
+// printUsage
+// ----------------------------------------------------------------------------
+//
+// Prints usage information to stderr.
+// 使用方法を stderr に出力する。
+//
+// ----------------------------------------------------------------------------
+void printUsage(const char* program_name) {
+    std::cerr << "Usage: " << program_name << " --polyhedron PATH FILE... [--threads N] [--tolerance VALUE] [--limit N]\n";
+    std::cerr << "\n";
+    std::cerr << "Options:\n";
+    std::cerr << "  --polyhedron PATH   Path to the polyhedron.json file the records were generated from\n";
+    std::cerr << "  --threads N         Number of threads per file (default: CPUs available)\n";
+    std::cerr << "  --tolerance VALUE   Maximum difference for x, y, and angle_deg (default: 1e-6)\n";
+    std::cerr << "  --limit N           Maximum number of errors to list per file (default: all)\n";
+    std::cerr << "\n";
+    std::cerr << "Input: partial unfolding JSONL (raw.jsonl, noniso.jsonl, or exact.jsonl)\n";
+    std::cerr << "Exit status: 0 if all records are valid, 1 if any record is invalid, 2 on error\n";
+}
+
+// ----------------------------------------------------------------------------
+// parseArgs
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   argc : Argument count
+//   argv : Argument vector
+//
+// 入力:
+//   argc : 引数の数
+//   argv : 引数のベクター
+//
+// Output:
+//   Returns a CliArgs structure with parsed arguments.
+//   If parsing fails, CliArgs.valid is false.
+//
+// 出力:
+//   解析された引数を含む CliArgs 構造体を返す。
+//   解析が失敗した場合、CliArgs.valid は false。
+//
+// Guarantee:
+//   - Validates required arguments (--polyhedron, at least one file)
+//   - Validates --threads is a positive integer, --tolerance is a
+//     non-negative number, and --limit is non-negative
+//   - Writes error messages to stderr on failure
+//
+// 保証:
+//   - 必須引数（--polyhedron、1つ以上のファイル）を検証
+//   - --threads が正の整数、--tolerance が非負の数値、--limit が非負であることを検証
+//   - 失敗時に stderr にエラーメッセージを書き込み
+//
+// ----------------------------------------------------------------------------
+CliArgs parseArgs(int argc, char* argv[]) {
+    CliArgs args;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--polyhedron" && i + 1 < argc) {
+            args.polyhedron_path = argv[++i];
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            try {
+                args.num_threads = std::stoi(argv[++i]);
+            } catch (...) {
+                args.num_threads = -1;
+            }
+            if (args.num_threads < 1) {
+                std::cerr << "Error: --threads must be a positive integer\n";
+                return args;
+            }
+        }
+        else if (arg == "--tolerance" && i + 1 < argc) {
+            try {
+                args.tolerance = std::stod(argv[++i]);
+            } catch (...) {
+                args.tolerance = -1.0;
+            }
+            if (args.tolerance < 0.0) {
+                std::cerr << "Error: --tolerance must be a non-negative number\n";
+                return args;
+            }
+        }
+        else if (arg == "--limit" && i + 1 < argc) {
+            try {
+                args.limit = std::stoll(argv[++i]);
+            } catch (...) {
+                args.limit = -1;
+            }
+            if (args.limit < 0) {
+                std::cerr << "Error: --limit must be a non-negative integer\n";
+                return args;
+            }
+        }
+        else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Error: Unknown argument: " << arg << "\n";
+            return args;
+        }
+        else {
+            args.paths.push_back(arg);
+        }
+    }
+
+    if (args.polyhedron_path.empty() || args.paths.empty()) {
+        std::cerr << "Error: --polyhedron and at least one file are required\n";
+        return args;
+    }
+
+    if (args.num_threads == 0) {
+        args.num_threads = CpuTopology::defaultThreadCount();
+    }
+
+    args.valid = true;
+    return args;
+}
+
+// ============================================================================
+// Validation
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// FailedRecord
+// ----------------------------------------------------------------------------
+//
+// A record that failed validation (or a line that could not be parsed).
+// 検証に失敗したレコード（または解析できなかった行）。
+//
+// ----------------------------------------------------------------------------
+struct FailedRecord {
+    long long line;                  // 1-based line number in the file
+    int base_face;                   // base_pair.base_face (-1 if unparsable)
+    int base_edge;                   // base_pair.base_edge (-1 if unparsable)
+    PathReplay::ReplayError error;   // First failed check
+};
+
+// ----------------------------------------------------------------------------
+// validateFile
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   path        : Path to a JSONL file
+//   poly        : Polyhedron the records were generated from
+//   args        : Parsed CLI arguments (threads, tolerance)
+//   num_records : Reference to store the number of lines checked
+//   failed      : Reference to store the failed records in file order
+//
+// 入力:
+//   path        : JSONL ファイルへのパス
+//   poly        : レコードの生成元の多面体
+//   args        : 解析済みのCLI引数（スレッド数、許容誤差）
+//   num_records : 検査した行数を格納する参照
+//   failed      : 失敗したレコードをファイル順に格納する参照
+//
+// Output:
+//   Returns true if the file was read, false if it cannot be opened.
+//   A line that is not a partial unfolding record counts as a failed record
+//   with check "parse".
+//
+// 出力:
+//   ファイルを読めた場合は true、開けない場合は false を返す。
+//   部分展開図レコードでない行は、検査名 "parse" の失敗レコードとして数える。
+//
+// ----------------------------------------------------------------------------
+bool validateFile(const std::string& path,
+                  const Polyhedron& poly,
+                  const CliArgs& args,
+                  long long& num_records,
+                  std::vector<FailedRecord>& failed) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Error: Cannot open file: " << path << "\n";
+        return false;
+    }
+
+    const char* data = file.data();
+    std::vector<RecordReader::Chunk> chunks =
+        RecordReader::splitIntoChunks(data, file.size(), args.num_threads);
+    std::vector<std::vector<FailedRecord>> partial(chunks.size());
+    std::vector<long long> counts(chunks.size(), 0);
+
+    RecordReader::forEachChunkParallel(chunks, [&](size_t c, const RecordReader::Chunk& chunk) {
+        ParsedRecord record;
+        PathReplay::ReplayError error;
+        long long line = 0;
+        RecordReader::forEachLine(data, chunk, [&](const char* text, size_t len) {
+            ++line;
+            if (!RecordReader::parseRecord(text, len, record)) {
+                partial[c].push_back({line, -1, -1, {-1, "parse", "not a partial unfolding record"}});
+                return;
+            }
+            if (!PathReplay::replayRecord(poly, record, args.tolerance, error)) {
+                partial[c].push_back({line, record.base_face, record.base_edge, error});
+            }
+        });
+        counts[c] = line;
+    });
+
+    // Convert chunk-local line numbers to file-wide line numbers
+    // チャンク内の行番号をファイル全体の行番号に変換
+    num_records = 0;
+    failed.clear();
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        for (auto& f : partial[c]) {
+            f.line += num_records;
+            failed.push_back(std::move(f));
+        }
+        num_records += counts[c];
+    }
+    return true;
+}
+
+// ============================================================================
+// Main Entry Point
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// main
+// ----------------------------------------------------------------------------
+//
+// Input:
+//   argc : Argument count
+//   argv : Argument vector
+//
+// 入力:
+//   argc : 引数の数
+//   argv : 引数のベクター
+//
+// Output:
+//   Returns 0 if every record of every file is valid, 1 if any record is
+//   invalid, and 2 on error (bad arguments, unreadable input).
+//
+// 出力:
+//   すべてのファイルのすべてのレコードが正しければ 0、不正なレコードがあれば 1、
+//   エラー時（不正な引数、読めない入力）は 2 を返す。
+//
+// ----------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+    CliArgs args = parseArgs(argc, argv);
+    if (!args.valid) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    Polyhedron poly;
+    if (!IOUtil::loadPolyhedronFromJson(args.polyhedron_path, poly)) {
+        return 2;
+    }
+
+    int status = 0;
+    for (const auto& path : args.paths) {
+        long long num_records = 0;
+        std::vector<FailedRecord> failed;
+        if (!validateFile(path, poly, args, num_records, failed)) {
+            status = 2;
+            continue;
+        }
+
+        json summary = {
+            {"record_type", "validation_summary"},
+            {"path", path},
+            {"num_records", num_records},
+            {"num_failed", failed.size()}
+        };
+        std::cout << summary.dump() << "\n";
+
+        long long listed = 0;
+        for (const auto& f : failed) {
+            if (args.limit > 0 && listed >= args.limit) break;
+            json entry = {
+                {"record_type", "validation_error"},
+                {"line", f.line},
+                {"base_pair", {{"base_face", f.base_face}, {"base_edge", f.base_edge}}},
+                {"face_index", f.error.face_index},
+                {"check", f.error.check},
+                {"detail", f.error.detail}
+            };
+            std::cout << entry.dump() << "\n";
+            ++listed;
+        }
+
+        if (!failed.empty()) {
+            std::cerr << "Error: " << path << ": " << failed.size() << " of "
+                      << num_records << " record(s) failed validation\n";
+            if (status == 0) status = 1;
+        } else {
+            std::cerr << "Info: " << path << ": all " << num_records << " record(s) valid\n";
+        }
+    }
+
+    return status;
+}
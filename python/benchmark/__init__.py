@@ -0,0 +1,12 @@
+"""
+Pipeline phase benchmark module for rotational unfolding.
+
+Measures Phase 1, Phase 2, Phase 3, and drawing separately on a catalog
+subset and compares the results with a stored baseline.
+
+パイプラインのフェーズ別ベンチマークモジュール。
+カタログの一部について Phase 1, Phase 2, Phase 3, 描画を個別に計測し、
+保存済みのベースラインと比較します。
+"""
+
+__version__ = "0.1.0"
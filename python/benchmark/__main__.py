@@ -0,0 +1,10 @@
+"""
+Main entry point for the pipeline benchmark module.
+
+Entry point for `python -m benchmark` execution.
+"""
+
+from benchmark.cli import main
+
+if __name__ == "__main__":
+    main()
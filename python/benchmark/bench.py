@@ -0,0 +1,522 @@
+"""
+Pipeline phase benchmark.
+
+Handles:
+- Running Phase 1, Phase 2, Phase 3, and drawing separately on a catalog subset
+- Measuring wall time, CPU time, and peak RSS of each phase in its own process
+- Counting records in and out of each phase
+- Comparing the results with a stored baseline
+
+パイプラインのフェーズ別ベンチマーク：
+- カタログの一部について Phase 1, Phase 2, Phase 3, 描画を個別に実行
+- 各フェーズを個別のプロセスで実行し、経過時間、CPU 時間、最大 RSS を計測
+- 各フェーズの入出力レコード数を数える
+- 保存済みのベースラインとの比較
+
+Phases read and write a scratch directory only; output/ and the shared cost
+model are never modified.
+各フェーズはスクラッチディレクトリのみを読み書きし、output/ と共有コストモデルは
+変更しない。
+"""
+
+import ctypes
+import json
+import os
+import platform
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from datetime import datetime, timezone
+from pathlib import Path
+
+from poly_resolve import find_repo_root, resolve_poly
+from rotational_unfolding.runner import count_jsonl_records, find_cost_model, find_cpp_binary
+
+# Fixed catalog subset: one or two polyhedra per class, each finishing all
+# phases within about half a minute
+# 固定のカタログの一部: 各クラスから1〜2個。いずれも全フェーズが30秒程度以内に終わる
+DEFAULT_CATALOG = [
+    "data/polyhedra/platonic/r05",
+    "data/polyhedra/archimedean/s08",
+    "data/polyhedra/archimedean/s12L",
+    "data/polyhedra/johnson/n22",
+    "data/polyhedra/johnson/n58",
+    "data/polyhedra/prism/p24",
+    "data/polyhedra/antiprism/a12",
+]
+
+PHASES = ["phase1", "phase2", "phase3", "drawing"]
+
+# Python phases: (module, function, input file, output path) run as
+# function(input, polyhedron.json, output) or function(input, output)
+# Python のフェーズ: (モジュール, 関数, 入力ファイル, 出力パス)
+_PYTHON_PHASES = {
+    "phase2": ("nonisomorphic.remove_isomorphic", "remove_isomorphic_duplicates",
+               "raw.jsonl", "noniso.jsonl"),
+    "phase3": ("exact.exact_overlap", "filter_exact_overlaps",
+               "noniso.jsonl", "exact.jsonl"),
+    "drawing": ("drawing.draw_raw", "draw_raw_jsonl",
+                "exact.jsonl", "svg"),
+}
+
+_PHASE_SCRIPT = (
+    "import importlib, sys\n"
+    "from pathlib import Path\n"
+    "module = importlib.import_module(sys.argv[1])\n"
+    "getattr(module, sys.argv[2])(*[Path(arg) for arg in sys.argv[3:]])\n"
+)
+
+
+# ptrace requests, options, and events (linux/ptrace.h), and __WALL (linux/wait.h)
+# ptrace の要求、オプション、イベント（linux/ptrace.h）と __WALL（linux/wait.h）
+_PTRACE_TRACEME = 0
+_PTRACE_CONT = 7
+_PTRACE_SETOPTIONS = 0x4200
+_PTRACE_O_TRACEFORK = 0x02
+_PTRACE_O_TRACEVFORK = 0x04
+_PTRACE_O_TRACEEXEC = 0x10
+_PTRACE_O_TRACEEXIT = 0x40
+_PTRACE_EVENT_EXIT = 6
+_WALL = 0x40000000
+
+_libc = ctypes.CDLL(None, use_errno=True)
+_libc.ptrace.argtypes = [ctypes.c_long, ctypes.c_long, ctypes.c_void_p, ctypes.c_void_p]
+_libc.ptrace.restype = ctypes.c_long
+
+
+def _ptrace(request, pid=0, data=0):
+    return _libc.ptrace(request, pid, None, ctypes.c_void_p(data))
+
+
+def _peak_rss_kib(pid):
+    """Returns the VmHWM of a live process in KiB, or 0 if it cannot be read."""
+    try:
+        with open(f"/proc/{pid}/status", "rb") as f:
+            for line in f:
+                if line.startswith(b"VmHWM:"):
+                    return int(line.split()[1])
+    except (OSError, ValueError):
+        pass
+    return 0
+
+
+def measure(argv, log_path, env=None):
+    """
+    Runs a command and measures it.
+
+    コマンドを実行して計測する。
+
+    Args:
+        argv (list): Command line.
+        log_path (Path): File receiving the command's stdout and stderr.
+        env (dict or None): Environment (None = inherited).
+
+    Returns:
+        dict: wall_s, cpu_s (user + system), peak_rss_mib, exit_code.
+
+    Notes:
+        - CPU time comes from os.wait4, which includes the children the
+          command waited for, so worker pools of a phase are included
+        - Peak RSS is the largest VmHWM of the command and of the processes
+          it forks, each read when the process exits (the command runs under
+          ptrace, stopping at every exit). ru_maxrss is not used: the kernel
+          carries the high-water mark of the forking Python process across
+          execve, so even /bin/true would report the benchmark's own RSS
+        - If ptrace is not permitted, ru_maxrss is reported instead (an upper
+          bound), with a warning
+        - CPU 時間は os.wait4 から得る。コマンドが待機した子プロセスを含むため、
+          フェーズのワーカープールも含まれる
+        - 最大 RSS は、コマンドとそれが fork したプロセスの VmHWM のうち最大のもので、
+          各プロセスの終了時に読む（コマンドは ptrace 下で実行し、各終了で停止させる）。
+          ru_maxrss は使わない: カーネルは fork 元の Python プロセスの最大値を
+          execve を越えて引き継ぐため、/bin/true でさえベンチマーク自身の RSS を
+          報告してしまう
+        - ptrace が許可されていない場合は、代わりに ru_maxrss（上限値）を警告付きで
+          報告する
+    """
+    with open(log_path, "w", encoding="utf-8") as log:
+        start = time.perf_counter()
+        process = subprocess.Popen(argv, stdout=log, stderr=subprocess.STDOUT, env=env,
+                                   preexec_fn=lambda: _ptrace(_PTRACE_TRACEME))
+        try:
+            wall, status, usage, peak_kib = _trace(process.pid, start)
+        except BaseException:
+            process.kill()
+            raise
+    process.returncode = os.waitstatus_to_exitcode(status)
+
+    if peak_kib is None:
+        print("Warning: ptrace is not permitted; peak RSS includes the benchmark's own",
+              file=sys.stderr)
+        peak_kib = usage.ru_maxrss  # ru_maxrss is in KiB on Linux
+
+    return {
+        "wall_s": wall,
+        "cpu_s": usage.ru_utime + usage.ru_stime,
+        "peak_rss_mib": peak_kib / 1024.0,
+        "exit_code": process.returncode,
+    }
+
+
+def _trace(root, start):
+    """
+    Runs the traced command root to completion, and every process it forked.
+
+    トレース中のコマンド root と、それが fork したすべてのプロセスを完了まで実行する。
+
+    Returns:
+        tuple: (wall seconds until root exited, its wait status, its rusage,
+            largest VmHWM in KiB, or None if root was not traced).
+    """
+    peak_kib = None
+    seen = set()
+    result = None
+    while True:
+        try:
+            pid, status, usage = os.wait4(-1, _WALL)
+        except ChildProcessError:
+            break
+        if not os.WIFSTOPPED(status):
+            if pid == root:
+                result = (time.perf_counter() - start, status, usage)
+            continue
+
+        # The first stop of root follows its execve; the first stop of a
+        # forked process is the SIGSTOP of its attachment
+        # root の最初の停止は execve の後、fork されたプロセスの最初の停止は
+        # アタッチ時の SIGSTOP
+        deliver = os.WSTOPSIG(status)
+        if pid not in seen:
+            seen.add(pid)
+            deliver = 0
+            if pid == root:
+                peak_kib = 0
+                _ptrace(_PTRACE_SETOPTIONS, root, _PTRACE_O_TRACEFORK | _PTRACE_O_TRACEVFORK
+                        | _PTRACE_O_TRACEEXEC | _PTRACE_O_TRACEEXIT)
+        elif status >> 16:
+            if status >> 16 == _PTRACE_EVENT_EXIT:
+                peak_kib = max(peak_kib, _peak_rss_kib(pid))
+            deliver = 0
+        _ptrace(_PTRACE_CONT, pid, deliver)
+
+    wall, status, usage = result
+    return wall, status, usage, peak_kib
+
+
+def _phase1_argv(repo_root, data_dir, work_dir, threads, pin):
+    argv = [
+        str(find_cpp_binary(repo_root)),
+        "--polyhedron", str(data_dir / "polyhedron.json"),
+        "--roots", str(data_dir / "root_pairs.json"),
+        "--symmetric", "auto",
+        "--out", str(work_dir / "raw.jsonl"),
+        "--cost-model", str(work_dir / "cost_model.json"),
+    ]
+    if threads is not None:
+        argv += ["--threads", str(threads)]
+    if pin:
+        argv.append("--pin")
+    return argv
+
+
+def _python_phase_argv(phase, data_dir, work_dir):
+    module, function, input_name, output_name = _PYTHON_PHASES[phase]
+    argv = [sys.executable, "-c", _PHASE_SCRIPT, module, function, str(work_dir / input_name)]
+    if phase != "drawing":
+        argv.append(str(data_dir / "polyhedron.json"))
+    argv.append(str(work_dir / output_name))
+    return argv
+
+
+def _count_records(phase, data_dir, work_dir):
+    """Returns (records_in, records_out) of a phase that has run."""
+    if phase == "phase1":
+        with open(data_dir / "root_pairs.json", "r", encoding="utf-8") as f:
+            records_in = len(json.load(f).get("root_pairs", []))
+        return records_in, count_jsonl_records(work_dir / "raw.jsonl")
+    _, _, input_name, output_name = _PYTHON_PHASES[phase]
+    records_in = count_jsonl_records(work_dir / input_name)
+    if phase == "drawing":
+        return records_in, len(list((work_dir / output_name).glob("*.svg")))
+    return records_in, count_jsonl_records(work_dir / output_name)
+
+
+def _run_phase(phase, argv, data_dir, work_dir, repeat, env, cost_model=None):
+    """
+    Runs a phase repeat times and returns the fastest run.
+
+    Every run starts from the same inputs: the drawing output is removed, and
+    cost_model (if it exists) is copied over the Phase 1 model that the
+    previous run updated.
+    """
+    best = None
+    for _ in range(repeat):
+        if phase == "drawing":
+            shutil.rmtree(work_dir / "svg", ignore_errors=True)
+        if cost_model is not None and cost_model.is_file():
+            shutil.copyfile(cost_model, work_dir / "cost_model.json")
+        log_path = work_dir / f"{phase}.log"
+        result = measure(argv, log_path, env)
+        if result["exit_code"] != 0:
+            tail = log_path.read_text(encoding="utf-8", errors="replace").splitlines()[-10:]
+            raise RuntimeError(f"{phase} exited with code {result['exit_code']}:\n" + "\n".join(tail))
+        if phase == "phase1":
+            result["nodes"] = _phase1_nodes(log_path)
+        if best is None or result["wall_s"] < best["wall_s"]:
+            best = result
+    del best["exit_code"]
+    best["records_in"], best["records_out"] = _count_records(phase, data_dir, work_dir)
+    return best
+
+
+def benchmark_polyhedron(repo_root, poly_id, work_dir, threads=None, pin=False,
+                         scaling=None, repeat=1):
+    """
+    Runs all phases for one polyhedron and measures each.
+
+    1つの多面体について全フェーズを実行し、それぞれを計測する。
+
+    Args:
+        repo_root (Path): Repository root path.
+        poly_id (str): Path to polyhedron data directory.
+        work_dir (Path): Empty scratch directory for the phase outputs.
+        threads (int or None): Phase 1 worker threads (None = C++ default).
+        pin (bool): Pin Phase 1 worker threads (rotunfold --pin).
+        scaling (list or None): Additional Phase 1 thread counts to measure.
+        repeat (int): Runs per phase; the fastest run is reported.
+
+    Returns:
+        list: One result dict per phase run, with poly, phase, threads,
+            scaling, wall_s, cpu_s, peak_rss_mib, records_in, records_out,
+            and for Phase 1 the number of NUMA nodes its workers ran on (nodes).
+
+    Notes:
+        - Every Phase 1 run, including each repeat, starts from a fresh copy
+          of the shared cost model, so its schedule matches a normal run
+          without updating the model
+        - Phase 1 の各実行（繰り返しを含む）は共有コストモデルの新しいコピーから
+          始まるため、モデルを更新せずに通常の実行と同じスケジュールになる
+    """
+    data_dir, _, poly_class, poly_name = resolve_poly(repo_root, poly_id)
+    label = f"{poly_class}/{poly_name}"
+    cost_model = find_cost_model(repo_root)
+    env = dict(os.environ, PYTHONPATH=str(repo_root / "python"))
+
+    results = []
+
+    def record(phase, phase_threads, is_scaling, result):
+        results.append(dict({"poly": label, "phase": phase, "threads": phase_threads,
+                             "scaling": is_scaling}, **result))
+
+    for t in scaling or []:
+        print(f"[benchmark] {label}: phase1 (threads={t})", file=sys.stderr, flush=True)
+        argv = _phase1_argv(repo_root, data_dir, work_dir, t, pin)
+        record("phase1", t, True,
+               _run_phase("phase1", argv, data_dir, work_dir, repeat, env, cost_model))
+
+    for phase in PHASES:
+        print(f"[benchmark] {label}: {phase}", file=sys.stderr, flush=True)
+        if phase == "phase1":
+            argv = _phase1_argv(repo_root, data_dir, work_dir, threads, pin)
+        else:
+            argv = _python_phase_argv(phase, data_dir, work_dir)
+        record(phase, threads if phase == "phase1" else None, False,
+               _run_phase(phase, argv, data_dir, work_dir, repeat, env,
+                          cost_model if phase == "phase1" else None))
+
+    return results
+
+
+def _parse_cpu_list(text):
+    """Parses a sysfs list such as "0-3,8" into a list of ints."""
+    values = []
+    for part in text.strip().split(","):
+        if "-" in part:
+            first, last = part.split("-")
+            values += range(int(first), int(last) + 1)
+        elif part:
+            values.append(int(part))
+    return values
+
+
+def _machine_topology():
+    """
+    Returns the NUMA nodes with CPUs and the CPU sockets of the machine,
+    or None for a count that sysfs does not provide.
+
+    CPU を持つ NUMA ノード数とマシンの CPU ソケット数を返す。sysfs から
+    得られない値は None。
+    """
+    topology = {"numa_nodes": None, "sockets": None}
+    try:
+        topology["numa_nodes"] = len(_parse_cpu_list(
+            Path("/sys/devices/system/node/has_cpu").read_text()))
+    except (OSError, ValueError):
+        pass
+    packages = set()
+    for path in Path("/sys/devices/system/cpu").glob("cpu[0-9]*/topology/physical_package_id"):
+        try:
+            packages.add(int(path.read_text()))
+        except (OSError, ValueError):
+            pass
+    if packages:
+        topology["sockets"] = len(packages)
+    return topology
+
+
+_NUMA_NODE_LINE = re.compile(r"^Info: NUMA node (\d+):", re.MULTILINE)
+
+
+def _phase1_nodes(log_path):
+    """
+    Returns the number of NUMA nodes Phase 1 placed workers on, from the
+    per-node lines rotunfold prints (only when there is more than one node).
+
+    rotunfold が出力するノードごとの行（ノードが2つ以上の場合のみ）から、
+    Phase 1 がワーカーを配置した NUMA ノード数を返す。
+    """
+    text = log_path.read_text(encoding="utf-8", errors="replace")
+    return max(1, len(set(_NUMA_NODE_LINE.findall(text))))
+
+
+def _git_commit(repo_root):
+    try:
+        return subprocess.run(["git", "rev-parse", "HEAD"], cwd=repo_root, capture_output=True,
+                              text=True, check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def run_benchmark(poly_ids=None, threads=None, pin=False, scaling=None, repeat=1, work_dir=None):
+    """
+    Runs the benchmark over a catalog subset.
+
+    カタログの一部についてベンチマークを実行する。
+
+    Args:
+        poly_ids (list or None): Polyhedron data directories (None = DEFAULT_CATALOG).
+        threads (int or None): Phase 1 worker threads (None = C++ default).
+        pin (bool): Pin Phase 1 worker threads.
+        scaling (list or None): Additional Phase 1 thread counts to measure.
+        repeat (int): Runs per phase; the fastest run is reported.
+        work_dir (Path or None): Directory to keep the phase outputs in
+            (None = a temporary directory, removed afterwards).
+
+    Returns:
+        dict: Benchmark report (see docs/BENCHMARK.md).
+    """
+    repo_root = find_repo_root()
+    poly_ids = poly_ids or DEFAULT_CATALOG
+
+    report = {
+        "schema_version": 1,
+        "record_type": "benchmark",
+        "created_at": datetime.now(timezone.utc).isoformat(),
+        "git_commit": _git_commit(repo_root),
+        "machine": {
+            "platform": platform.platform(),
+            "python": platform.python_version(),
+            "cpus": len(os.sched_getaffinity(0)),
+            **_machine_topology(),
+        },
+        "repeat": repeat,
+        "results": [],
+    }
+
+    with tempfile.TemporaryDirectory(prefix="rotunfold-bench-") as temp_dir:
+        root = Path(work_dir) if work_dir is not None else Path(temp_dir)
+        for poly_id in poly_ids:
+            _, _, poly_class, poly_name = resolve_poly(repo_root, poly_id)
+            poly_dir = root / poly_class / poly_name
+            shutil.rmtree(poly_dir, ignore_errors=True)
+            poly_dir.mkdir(parents=True)
+            report["results"] += benchmark_polyhedron(
+                repo_root, poly_id, poly_dir, threads, pin, scaling, repeat)
+
+    return report
+
+
+def _key(result):
+    return (result["poly"], result["phase"], result["threads"], result["scaling"])
+
+
+def _change(new, old):
+    """Relative change as a signed percentage, or "" without a baseline."""
+    if old is None:
+        return ""
+    if old == 0:
+        return "n/a"
+    return f"{(new - old) / old * 100.0:+.1f}%"
+
+
+def format_table(report, baseline=None):
+    """
+    Formats a report as Markdown tables, compared with a baseline if given.
+
+    レポートを Markdown の表として整形する（ベースラインが与えられた場合は比較する）。
+
+    Args:
+        report (dict): Benchmark report.
+        baseline (dict or None): Earlier benchmark report.
+
+    Returns:
+        str: Phase table (with each phase's share of the pipeline wall time),
+            followed by a Phase 1 scaling table when scaling runs exist, and
+            the list of phases whose record counts differ from the baseline.
+    """
+    base = {_key(r): r for r in baseline["results"]} if baseline else {}
+    main = [r for r in report["results"] if not r["scaling"]]
+    scaling = [r for r in report["results"] if r["scaling"]]
+
+    totals = {}
+    for r in main:
+        totals[r["poly"]] = totals.get(r["poly"], 0.0) + r["wall_s"]
+
+    lines = []
+    if baseline:
+        lines.append(f"Baseline: {baseline.get('created_at')} (commit {baseline.get('git_commit')})")
+        lines.append("")
+    lines.append("| Polyhedron | Phase | Wall (s) | Δ wall | Share | CPU (s) | Δ CPU "
+                 "| Peak RSS (MiB) | Δ RSS | Records in → out |")
+    lines.append("|---|---|---:|---:|---:|---:|---:|---:|---:|---|")
+
+    mismatches = []
+    for r in main:
+        old = base.get(_key(r))
+        share = r["wall_s"] / totals[r["poly"]] * 100.0 if totals[r["poly"]] > 0 else 0.0
+        lines.append(
+            f"| {r['poly']} | {r['phase']} "
+            f"| {r['wall_s']:.3f} | {_change(r['wall_s'], old and old['wall_s'])} | {share:.1f}% "
+            f"| {r['cpu_s']:.3f} | {_change(r['cpu_s'], old and old['cpu_s'])} "
+            f"| {r['peak_rss_mib']:.1f} | {_change(r['peak_rss_mib'], old and old['peak_rss_mib'])} "
+            f"| {r['records_in']} → {r['records_out']} |")
+        if old and (old["records_in"], old["records_out"]) != (r["records_in"], r["records_out"]):
+            mismatches.append(f"{r['poly']} {r['phase']}: baseline {old['records_in']} → "
+                              f"{old['records_out']}, now {r['records_in']} → {r['records_out']}")
+
+    if scaling:
+        lines.append("")
+        lines.append("Phase 1 scaling:")
+        lines.append("")
+        lines.append("| Polyhedron | Threads | Nodes | Wall (s) | Δ wall | CPU (s) | Speedup | Efficiency |")
+        lines.append("|---|---:|---:|---:|---:|---:|---:|---:|")
+        first = {}
+        for r in scaling:
+            reference = first.setdefault(r["poly"], r)
+            speedup = reference["wall_s"] / r["wall_s"] if r["wall_s"] > 0 else 0.0
+            efficiency = speedup * reference["threads"] / r["threads"]
+            old = base.get(_key(r))
+            lines.append(
+                f"| {r['poly']} | {r['threads']} | {r.get('nodes', 1)} | {r['wall_s']:.3f} "
+                f"| {_change(r['wall_s'], old and old['wall_s'])} | {r['cpu_s']:.3f} "
+                f"| {speedup:.2f}x | {efficiency * 100.0:.0f}% |")
+
+    if mismatches:
+        lines.append("")
+        lines.append("Record counts differ from the baseline:")
+        lines += [f"- {m}" for m in mismatches]
+
+    return "\n".join(lines) + "\n"
@@ -0,0 +1,171 @@
+"""
+CLI interface for the pipeline benchmark.
+
+Provides command-line interface for measuring each pipeline phase.
+パイプラインの各フェーズを計測するコマンドラインインターフェース。
+"""
+
+import argparse
+import json
+import sys
+from pathlib import Path
+
+from benchmark.bench import DEFAULT_CATALOG, format_table, run_benchmark
+
+
+def _thread_list(value):
+    try:
+        threads = [int(t) for t in value.split(",")]
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"invalid thread list: {value}")
+    if not threads or min(threads) < 1:
+        raise argparse.ArgumentTypeError(f"thread counts must be >= 1: {value}")
+    return threads
+
+
+def create_parser():
+    """
+    Creates and returns the argument parser for the benchmark CLI.
+
+    ベンチマーク CLI 用の引数パーサを作成して返す。
+
+    Returns:
+        argparse.ArgumentParser: Configured argument parser.
+    """
+    parser = argparse.ArgumentParser(
+        prog="benchmark",
+        description="Measure each pipeline phase on a catalog subset",
+    )
+
+    subparsers = parser.add_subparsers(dest="command", help="Available commands")
+
+    # run subcommand
+    run_parser = subparsers.add_parser(
+        "run",
+        help="Run the phases, write a report, and compare it with a baseline"
+    )
+
+    run_parser.add_argument(
+        "--poly",
+        action="append",
+        default=None,
+        help="Polyhedron data directory to measure; repeatable (default: fixed catalog subset)"
+    )
+
+    run_parser.add_argument(
+        "--baseline",
+        default=None,
+        help="Benchmark report (JSON) to compare with"
+    )
+
+    run_parser.add_argument(
+        "--out",
+        default=None,
+        help="Write the benchmark report (JSON) to this path, e.g. to store a new baseline"
+    )
+
+    run_parser.add_argument(
+        "--repeat",
+        type=int,
+        default=1,
+        help="Runs per phase; the fastest run is reported (default: 1)"
+    )
+
+    run_parser.add_argument(
+        "--threads",
+        type=int,
+        default=None,
+        help="Phase 1 worker threads (default: C++ default)"
+    )
+
+    run_parser.add_argument(
+        "--pin",
+        action="store_true",
+        default=False,
+        help="Pin Phase 1 worker threads to CPUs (rotunfold --pin)"
+    )
+
+    run_parser.add_argument(
+        "--scaling",
+        type=_thread_list,
+        default=None,
+        help="Comma-separated Phase 1 thread counts to measure in addition (e.g., 1,2,4,8)"
+    )
+
+    run_parser.add_argument(
+        "--work-dir",
+        default=None,
+        help="Keep the phase outputs in this directory (default: temporary directory)"
+    )
+
+    return parser
+
+
+def main():
+    """
+    Main entry point for the benchmark CLI.
+
+    ベンチマーク CLI のメイン入口。
+
+    Example usage:
+        PYTHONPATH=python python -m benchmark run --out baseline.json
+        PYTHONPATH=python python -m benchmark run --baseline baseline.json
+        PYTHONPATH=python python -m benchmark run --poly data/polyhedra/johnson/n20 --scaling 1,2,4
+
+    Process:
+        1. For each polyhedron, run Phase 1 (C++), Phase 2, Phase 3, and
+           drawing in order, each in its own process, in a scratch directory
+        2. Record wall time, CPU time, peak RSS, and record counts per phase
+        3. Print the comparison table (stdout) and write the report (--out)
+
+    処理:
+        1. 各多面体について、Phase 1 (C++), Phase 2, Phase 3, 描画を順に、
+           それぞれ個別のプロセスでスクラッチディレクトリ上で実行する
+        2. フェーズごとに経過時間、CPU 時間、最大 RSS、レコード数を記録する
+        3. 比較表を表示し（stdout）、レポートを書き込む（--out）
+    """
+    parser = create_parser()
+    args = parser.parse_args()
+
+    if args.command is None:
+        parser.print_help()
+        sys.exit(1)
+
+    if args.command == "run":
+        try:
+            if args.repeat < 1:
+                raise ValueError("--repeat must be >= 1")
+
+            baseline = None
+            if args.baseline is not None:
+                with open(args.baseline, "r", encoding="utf-8") as f:
+                    baseline = json.load(f)
+
+            print(f"[benchmark] Polyhedra: {len(args.poly or DEFAULT_CATALOG)}", file=sys.stderr)
+            report = run_benchmark(
+                poly_ids=args.poly,
+                threads=args.threads,
+                pin=args.pin,
+                scaling=args.scaling,
+                repeat=args.repeat,
+                work_dir=Path(args.work_dir) if args.work_dir is not None else None
+            )
+
+            if args.out is not None:
+                out_path = Path(args.out)
+                out_path.parent.mkdir(parents=True, exist_ok=True)
+                with open(out_path, "w", encoding="utf-8") as f:
+                    json.dump(report, f, indent=2)
+                    f.write("\n")
+                print(f"[benchmark] Report: {out_path}", file=sys.stderr)
+
+            print(format_table(report, baseline), end="")
+            sys.exit(0)
+
+        except Exception as e:
+            print(f"Error: {e}", file=sys.stderr)
+            sys.exit(1)
+
+    else:
+        parser.print_help()
+        sys.exit(1)
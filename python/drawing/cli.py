@@ -96,6 +96,20 @@ def create_parser():
         help="Hide face and edge labels (draw polygons only)"
     )
     
+    run_parser.add_argument(
+        "--jobs",
+        type=int,
+        default=1,
+        help="Number of worker processes for rendering (default: 1; 0 = all CPUs)"
+    )
+    
+    run_parser.add_argument(
+        "--incremental",
+        action="store_true",
+        default=False,
+        help="Skip SVG files whose input record and options are unchanged since the last run"
+    )
+    
     return parser
 
 
@@ -109,6 +123,7 @@ def main():
         PYTHONPATH=python python -m drawing run --type raw --poly data/polyhedra/archimedean/s07
         PYTHONPATH=python python -m drawing run --type noniso --poly data/polyhedra/platonic/r01
         PYTHONPATH=python python -m drawing run --type exact --poly data/polyhedra/johnson/n20
+        PYTHONPATH=python python -m drawing run --type raw --poly data/polyhedra/johnson/n40 --jobs 0 --incremental
     
     Execution model:
         すべての実行は cwd 非依存で、リポジトリルートを基準にパスを解決する。
@@ -142,7 +157,13 @@ def main():
             
             # Draw
             # 描画
-            num_generated = draw_raw_jsonl(input_jsonl, output_dir, show_labels=show_labels)
+            num_generated = draw_raw_jsonl(
+                input_jsonl,
+                output_dir,
+                show_labels=show_labels,
+                jobs=args.jobs,
+                incremental=args.incremental,
+            )
             print(f"Done. Generated {num_generated} SVG files.")
             
             sys.exit(0)
@@ -7,11 +7,58 @@ Converts partial unfolding records (raw/noniso/exact) to SVG files for visual in
 Based on scripts/draw_partial_unfolding.py (legacy implementation).
 """
 
+import hashlib
 import json
 import math
+import os
+from concurrent.futures import ProcessPoolExecutor
+from functools import lru_cache
 from pathlib import Path
 
 
+# Bump when the SVG layout changes so that incremental redraws are invalidated.
+# SVG のレイアウトを変更した場合は、差分再描画を無効化するために値を上げる。
+RENDERER_VERSION = 1
+
+# Name of the per-directory manifest used by incremental drawing.
+# 差分描画で使用するディレクトリごとのマニフェスト名。
+DRAW_MANIFEST_NAME = ".draw_manifest.json"
+
+
+@lru_cache(maxsize=None)
+def _vertex_offsets(gon, angle_deg):
+    """
+    Returns the vertex offsets of a regular n-gon relative to its center.
+
+    正 n 角形の中心からの頂点オフセットを返します。
+
+    Faces in an unfolding take only a few distinct (gon, angle_deg) values,
+    so the trigonometry is evaluated once per combination and shared by
+    every face and record that uses it.
+
+    展開図中の面がとる (gon, angle_deg) の組は少数であるため、三角関数は
+    組ごとに一度だけ評価され、それを使うすべての面・レコードで共有されます。
+
+    Args:
+        gon (int): Number of edges of the face
+        angle_deg (float): Edge normal direction of the face
+
+    Returns:
+        tuple: Tuple of (dx, dy) offsets, one per vertex
+    """
+    rot = 360.0 / float(gon)
+    d = angle_deg - rot / 2.0
+    radius = 1.0 / (2.0 * math.sin(math.pi / float(gon)))
+
+    offsets = []
+    for _ in range(gon):
+        offsets.append((radius * math.cos(math.pi * d / 180.0),
+                        radius * math.sin(math.pi * d / 180.0)))
+        d -= rot
+
+    return tuple(offsets)
+
+
 def compute_vertices(face):
     """
     Computes polygon vertices from a face record.
@@ -24,32 +71,13 @@ def compute_vertices(face):
     Returns:
         list: List of (x, y) tuples representing vertices
     """
-    gon = face["gon"]
     x_center = face["x"]
     y_center = face["y"]
-    angle_deg = face["angle_deg"]
-    
-    # Step angle between vertices
-    # 頂点間の角度ステップ
-    rot = 360.0 / float(gon)
     
-    # angle_deg is the direction of the edge normal;
-    # shift by half step to point to the vertex
-    # angle_deg は辺法線の向き。頂点を向くように半角ずらす
-    d = angle_deg - rot / 2.0
-    
-    # Circumradius of the n-gon
-    # n 角形の外接円の半径
-    radius = 1.0 / (2.0 * math.sin(math.pi / float(gon)))
-    
-    vertices = []
-    for _ in range(gon):
-        vx = x_center + radius * math.cos(math.pi * d / 180.0)
-        vy = y_center + radius * math.sin(math.pi * d / 180.0)
-        vertices.append((vx, vy))
-        d -= rot
-    
-    return vertices
+    # Vertices are the face center plus the cached offsets for (gon, angle_deg)
+    # 頂点は面の中心に (gon, angle_deg) ごとにキャッシュされたオフセットを加えたもの
+    return [(x_center + dx, y_center + dy)
+            for (dx, dy) in _vertex_offsets(face["gon"], face["angle_deg"])]
 
 
 def compute_viewbox(all_vertices, margin_factor=0.05):
@@ -89,19 +117,21 @@ def compute_viewbox(all_vertices, margin_factor=0.05):
     return x_min, y_min, width, height
 
 
-def write_svg(output_path, record, show_labels=True):
+def render_svg(record, show_labels=True):
     """
-    Writes a single partial unfolding record as an SVG file.
+    Renders a single partial unfolding record as SVG markup.
     
-    1つの部分展開図レコードを SVG ファイルとして書き出します。
+    1つの部分展開図レコードを SVG マークアップとして生成します。
     
     Args:
-        output_path (Path): Output SVG file path
         record (dict): Partial unfolding record from raw.jsonl
         show_labels (bool): If True, draw face_id and edge_id labels.
                             If False, draw polygons only (no text).
                             Default: True.
     
+    Returns:
+        str: Complete SVG document
+    
     SVG specification (fixed for consistency):
     - Coordinate system: raw.jsonl x, y coordinates as-is
     - Angle interpretation: angle_deg as edge normal direction
@@ -135,79 +165,183 @@ def write_svg(output_path, record, show_labels=True):
     font_scale = 0.002 * ref_size
     edge_bg_pad = 0.02 * ref_size
     
-    # Write SVG
-    with open(output_path, "w", encoding="utf-8") as out:
-        # Header
-        out.write('<?xml version="1.0" encoding="utf-8"?>\n')
-        out.write(
-            f'<svg version="1.1" '
-            f'xmlns="http://www.w3.org/2000/svg" '
-            f'viewBox="{vb_x} {vb_y} {vb_w} {vb_h}" '
-            f'style="enable-background:new {vb_x} {vb_y} {vb_w} {vb_h};">\n'
-        )
-        out.write('<style type="text/css">\n')
-        out.write('  .face_stroke {fill:none; stroke:#000000; stroke-width:0.02; stroke-miterlimit:10;}\n')
-        out.write('  .face_text {fill:#000000; font-family:monospace;}\n')
-        out.write('  .edge_text {fill:#ff0000; font-family:monospace;}\n')
-        out.write('  .edge_bg {fill:#f3f3f3; stroke:#606060; stroke-width:0.01;}\n')
-        out.write('</style>\n')
-        
-        # Draw polygons
-        # 多角形を描画
-        for verts in all_vertices:
-            pts = " ".join(f"{vx},{vy}" for (vx, vy) in verts)
-            out.write(f'<polygon class="face_stroke" points="{pts}"/>\n')
+    # Collect markup fragments and join them once at the end
+    # マークアップ断片を集め、最後に一度だけ連結する
+    parts = []
+    
+    # Header
+    parts.append('<?xml version="1.0" encoding="utf-8"?>\n')
+    parts.append(
+        f'<svg version="1.1" '
+        f'xmlns="http://www.w3.org/2000/svg" '
+        f'viewBox="{vb_x} {vb_y} {vb_w} {vb_h}" '
+        f'style="enable-background:new {vb_x} {vb_y} {vb_w} {vb_h};">\n'
+    )
+    parts.append('<style type="text/css">\n')
+    parts.append('  .face_stroke {fill:none; stroke:#000000; stroke-width:0.02; stroke-miterlimit:10;}\n')
+    parts.append('  .face_text {fill:#000000; font-family:monospace;}\n')
+    parts.append('  .edge_text {fill:#ff0000; font-family:monospace;}\n')
+    parts.append('  .edge_bg {fill:#f3f3f3; stroke:#606060; stroke-width:0.01;}\n')
+    parts.append('</style>\n')
+    
+    # Draw polygons
+    # 多角形を描画
+    for verts in all_vertices:
+        pts = " ".join(f"{vx},{vy}" for (vx, vy) in verts)
+        parts.append(f'<polygon class="face_stroke" points="{pts}"/>\n')
+    
+    # Draw face IDs and edge IDs (skipped when show_labels=False)
+    # 面番号と辺番号を描画（show_labels=False の場合はスキップ）
+    if show_labels:
+        # Draw face IDs at face centers
+        # 面番号を中心に描画
+        for face in faces:
+            x_center = face["x"]
+            y_center = face["y"]
+            face_id = face["face_id"]
+            parts.append(
+                f'<text class="face_text" text-anchor="middle" dominant-baseline="middle" '
+                f'transform="matrix({font_scale} 0 0 {font_scale} {x_center} {y_center})">'
+                f'{face_id}</text>\n'
+            )
         
-        # Draw face IDs and edge IDs (skipped when show_labels=False)
-        # 面番号と辺番号を描画（show_labels=False の場合はスキップ）
-        if show_labels:
-            # Draw face IDs at face centers
-            # 面番号を中心に描画
-            for face in faces:
-                x_center = face["x"]
-                y_center = face["y"]
-                face_id = face["face_id"]
-                out.write(
-                    f'<text class="face_text" text-anchor="middle" dominant-baseline="middle" '
-                    f'transform="matrix({font_scale} 0 0 {font_scale} {x_center} {y_center})">'
-                    f'{face_id}</text>\n'
-                )
+        # Draw edge IDs on shared edges (skip first face, which has no shared edge)
+        # 共有辺上に辺番号を描画（最初の面はスキップ、共有辺なし）
+        for i in range(1, len(faces)):
+            face = faces[i]
+            gon = face["gon"]
+            x_center = face["x"]
+            y_center = face["y"]
+            angle_deg = face["angle_deg"]
+            edge_id = face["edge_id"]
             
-            # Draw edge IDs on shared edges (skip first face, which has no shared edge)
-            # 共有辺上に辺番号を描画（最初の面はスキップ、共有辺なし）
-            for i in range(1, len(faces)):
-                face = faces[i]
-                gon = face["gon"]
-                x_center = face["x"]
-                y_center = face["y"]
-                angle_deg = face["angle_deg"]
-                edge_id = face["edge_id"]
-                
-                # Place label along the edge-normal direction at inradius distance
-                # 辺法線方向に内接円半径だけオフセットした位置に描画
-                inradius = 1.0 / (2.0 * math.tan(math.pi / float(gon)))
-                theta_rad = math.pi * angle_deg / 180.0
-                ex = x_center + inradius * math.cos(theta_rad)
-                ey = y_center + inradius * math.sin(theta_rad)
-                
-                # Draw background rectangle for edge ID
-                # 辺番号の背景矩形を描画
-                out.write(
-                    f'<rect class="edge_bg" '
-                    f'x="{ex - edge_bg_pad}" y="{ey - edge_bg_pad}" '
-                    f'width="{2 * edge_bg_pad}" height="{2 * edge_bg_pad}"/>\n'
-                )
-                out.write(
-                    f'<text class="edge_text" text-anchor="middle" dominant-baseline="middle" '
-                    f'transform="matrix({font_scale} 0 0 {font_scale} {ex} {ey})">'
-                    f'{edge_id}</text>\n'
-                )
-        
-        # Footer
-        out.write('</svg>\n')
+            # Place label along the edge-normal direction at inradius distance
+            # 辺法線方向に内接円半径だけオフセットした位置に描画
+            inradius = 1.0 / (2.0 * math.tan(math.pi / float(gon)))
+            theta_rad = math.pi * angle_deg / 180.0
+            ex = x_center + inradius * math.cos(theta_rad)
+            ey = y_center + inradius * math.sin(theta_rad)
+            
+            # Draw background rectangle for edge ID
+            # 辺番号の背景矩形を描画
+            parts.append(
+                f'<rect class="edge_bg" '
+                f'x="{ex - edge_bg_pad}" y="{ey - edge_bg_pad}" '
+                f'width="{2 * edge_bg_pad}" height="{2 * edge_bg_pad}"/>\n'
+            )
+            parts.append(
+                f'<text class="edge_text" text-anchor="middle" dominant-baseline="middle" '
+                f'transform="matrix({font_scale} 0 0 {font_scale} {ex} {ey})">'
+                f'{edge_id}</text>\n'
+            )
+    
+    # Footer
+    parts.append('</svg>\n')
+    
+    return "".join(parts)
 
 
-def draw_raw_jsonl(raw_jsonl_path, output_dir, show_labels=True):
+def write_svg(output_path, record, show_labels=True):
+    """
+    Writes a single partial unfolding record as an SVG file.
+    
+    1つの部分展開図レコードを SVG ファイルとして書き出します。
+    
+    Args:
+        output_path (Path): Output SVG file path
+        record (dict): Partial unfolding record from raw.jsonl
+        show_labels (bool): If True, draw face_id and edge_id labels.
+                            If False, draw polygons only (no text).
+                            Default: True.
+    
+    See render_svg() for the SVG specification.
+    SVG 仕様は render_svg() を参照。
+    """
+    with open(output_path, "w", encoding="utf-8") as out:
+        out.write(render_svg(record, show_labels=show_labels))
+
+
+def _input_digest(line, show_labels):
+    """
+    Returns a digest identifying the inputs of one SVG file.
+    
+    1つの SVG ファイルの入力を識別するダイジェストを返します。
+    
+    The digest covers the JSONL line, the label option and RENDERER_VERSION,
+    so any change that could alter the SVG also changes the digest.
+    
+    ダイジェストは JSONL 行、ラベルオプション、RENDERER_VERSION を含むため、
+    SVG を変化させうる変更は必ずダイジェストも変化させます。
+    """
+    h = hashlib.blake2b(digest_size=16)
+    h.update(f"v{RENDERER_VERSION};labels={int(show_labels)};".encode("utf-8"))
+    h.update(line.encode("utf-8"))
+    return h.hexdigest()
+
+
+def _load_draw_manifest(output_dir):
+    """
+    Loads the incremental drawing manifest ({svg filename: input digest}).
+    
+    差分描画用マニフェスト（{SVG ファイル名: 入力ダイジェスト}）を読み込みます。
+    Returns an empty dict if the manifest is missing or unreadable.
+    マニフェストが存在しない・読めない場合は空の dict を返します。
+    """
+    manifest_path = output_dir / DRAW_MANIFEST_NAME
+    try:
+        with open(manifest_path, "r", encoding="utf-8") as f:
+            data = json.load(f)
+        if data.get("renderer_version") == RENDERER_VERSION:
+            return data.get("files", {})
+    except (OSError, ValueError):
+        pass
+    return {}
+
+
+def _save_draw_manifest(output_dir, files):
+    """
+    Writes the incremental drawing manifest.
+    
+    差分描画用マニフェストを書き出します。
+    """
+    manifest_path = output_dir / DRAW_MANIFEST_NAME
+    with open(manifest_path, "w", encoding="utf-8") as f:
+        json.dump({"renderer_version": RENDERER_VERSION, "files": files},
+                  f, indent=0, sort_keys=True)
+        f.write("\n")
+
+
+def _render_batch(output_dir, batch, show_labels):
+    """
+    Renders a batch of records and writes the resulting SVG files.
+    
+    レコードのバッチを描画し、得られた SVG ファイルを書き出します。
+    
+    Runs inside a worker process. JSON parsing and SVG generation for the
+    whole batch are done first, then all files are written back to back.
+    
+    ワーカープロセス内で実行される。バッチ全体の JSON 解析と SVG 生成を
+    先に済ませ、その後すべてのファイルを連続して書き出す。
+    
+    Args:
+        output_dir (str): Output directory for SVG files
+        batch (list): List of (svg_filename, jsonl_line) tuples
+        show_labels (bool): Whether to draw face and edge labels
+    
+    Returns:
+        int: Number of SVG files written
+    """
+    rendered = [(name, render_svg(json.loads(line), show_labels=show_labels))
+                for (name, line) in batch]
+    
+    for name, svg in rendered:
+        with open(os.path.join(output_dir, name), "w", encoding="utf-8") as out:
+            out.write(svg)
+    
+    return len(rendered)
+
+
+def draw_raw_jsonl(raw_jsonl_path, output_dir, show_labels=True, jobs=1, incremental=False):
     """
     Draws all records in a raw.jsonl file as individual SVG files.
     
@@ -218,9 +352,14 @@ def draw_raw_jsonl(raw_jsonl_path, output_dir, show_labels=True):
         output_dir (Path): Output directory for SVG files
         show_labels (bool): If True, draw face_id and edge_id labels.
                             If False, draw polygons only. Default: True.
+        jobs (int): Number of worker processes. 1 renders in-process,
+                    0 uses os.cpu_count(). Default: 1.
+        incremental (bool): If True, skip SVG files whose input record and
+                            options are unchanged since the previous run.
+                            Default: False.
     
     Returns:
-        int: Number of SVG files generated
+        int: Number of SVG files generated (skipped files are not counted)
     
     Output structure:
         output_dir/000000.svg (6-digit zero-padded, 0-based index)
@@ -231,17 +370,27 @@ def draw_raw_jsonl(raw_jsonl_path, output_dir, show_labels=True):
         output_dir/000000.svg（6桁ゼロ埋め、0-based インデックス）
         output_dir/000001.svg
         ...
+    
+    Parallel mode:
+        Records are split into contiguous batches and rendered on a process
+        pool. File names depend only on the record index, so the output is
+        identical to a serial run regardless of the number of workers.
+    
+    並列モード:
+        レコードを連続したバッチに分割してプロセスプールで描画する。
+        ファイル名はレコード番号のみで決まるため、ワーカー数によらず
+        逐次実行と同一の出力になる。
     """
-    # Read all records from raw.jsonl
-    # raw.jsonl からすべてのレコードを読み込む
-    records = []
+    # Read all lines from raw.jsonl (parsing is deferred to the renderers)
+    # raw.jsonl からすべての行を読み込む（解析は描画側で行う）
+    lines = []
     with open(raw_jsonl_path, "r", encoding="utf-8") as f:
         for line in f:
             line = line.strip()
             if line:
-                records.append(json.loads(line))
+                lines.append(line)
     
-    if not records:
+    if not lines:
         print(f"Warning: No records found in {raw_jsonl_path}")
         return 0
     
@@ -251,13 +400,58 @@ def draw_raw_jsonl(raw_jsonl_path, output_dir, show_labels=True):
     
     # Compute zero-padding width based on total record count (0-based indexing)
     # 総レコード数に基づいて0埋め桁数を計算（0-based インデックス）
-    width = len(str(len(records) - 1))
-    
-    # Draw each record
-    # 各レコードを描画
-    for idx, record in enumerate(records):
-        svg_filename = f"{str(idx).zfill(width)}.svg"
-        svg_path = output_dir / svg_filename
-        write_svg(svg_path, record, show_labels=show_labels)
-    
-    return len(records)
+    width = len(str(len(lines) - 1))
+    names = [f"{str(idx).zfill(width)}.svg" for idx in range(len(lines))]
+    
+    # Select the records to draw (all of them unless incremental). Digests
+    # are computed on every run so that the manifest always describes the
+    # SVG files on disk
+    # 描画するレコードを選択（差分モードでなければすべて）。マニフェストが常に
+    # ディスク上の SVG ファイルを表すよう、ダイジェストは毎回計算する
+    previous = _load_draw_manifest(output_dir) if incremental else {}
+    digests = {}
+    unchanged = {}
+    pending = []
+    for name, line in zip(names, lines):
+        digest = _input_digest(line, show_labels)
+        digests[name] = digest
+        if incremental and previous.get(name) == digest and (output_dir / name).is_file():
+            unchanged[name] = digest
+            continue
+        pending.append((name, line))
+    
+    # Drop the files about to be overwritten from the manifest before drawing,
+    # so that an interrupted run never leaves a manifest vouching for them
+    # 中断した実行が上書き途中のファイルを保証するマニフェストを残さないよう、
+    # 描画前に上書き予定のファイルをマニフェストから除く
+    if pending:
+        _save_draw_manifest(output_dir, unchanged)
+    
+    if jobs == 0:
+        jobs = os.cpu_count() or 1
+    
+    # Draw the selected records
+    # 選択したレコードを描画
+    num_generated = 0
+    if jobs <= 1 or len(pending) < 2:
+        num_generated = _render_batch(str(output_dir), pending, show_labels)
+    else:
+        # A few batches per worker keeps the pool balanced without paying
+        # per-record pickling overhead
+        # ワーカーあたり数個のバッチに分けることで、レコード単位の
+        # pickle オーバーヘッドを避けつつ負荷を均等化する
+        batch_size = max(1, -(-len(pending) // (jobs * 4)))
+        batches = [pending[i:i + batch_size] for i in range(0, len(pending), batch_size)]
+        with ProcessPoolExecutor(max_workers=jobs) as pool:
+            futures = [pool.submit(_render_batch, str(output_dir), batch, show_labels)
+                       for batch in batches]
+            for future in futures:
+                num_generated += future.result()
+    
+    # Record the inputs of every SVG file for the next incremental run, also
+    # after a full run, which may have overwritten files of an earlier one
+    # 次回の差分実行のために、すべての SVG ファイルの入力を記録する。全体実行も
+    # 以前の実行のファイルを上書きしうるため、同様に記録する
+    _save_draw_manifest(output_dir, digests)
+    
+    return num_generated
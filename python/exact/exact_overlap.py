@@ -16,6 +16,7 @@ Key differences from legacy:
 """
 
 import json
+import math
 from pathlib import Path
 
 from sympy import S, pi, sin, cos, tan, sympify, Abs
@@ -42,6 +43,8 @@ def load_polyhedron_structure(polyhedron_json_path):
             - adj_edges (list): Adjacency edges for each face
             - adj_faces (list): Adjacency faces for each face
             - vertices (list): Vertex IDs for each face (computed from edge adjacency)
+            - vertex_table (dict): Vertex offsets and edge normals for each
+              (gon, orientation) (see _build_vertex_table); read-only
     """
     with open(polyhedron_json_path, "r", encoding="utf-8") as f:
         data = json.load(f)
@@ -72,6 +75,7 @@ def load_polyhedron_structure(polyhedron_json_path):
         "adj_edges": adj_edges,
         "adj_faces": adj_faces,
         "vertices": vertices,
+        "vertex_table": _build_vertex_table(gon_list),
     }
 
 
@@ -283,31 +287,113 @@ def build_exact_positions(poly, faces):
     return results
 
 
-def _get_vertices_of_face(gon, cx, cy, ang):
+# ---------------------------------------------------------------------------
+# Vertex offset table
+# 頂点オフセット表
+# ---------------------------------------------------------------------------
+
+def _build_vertex_table(gon_list):
+    """
+    Precompute the vertex offsets and edge normals of every face orientation.
+
+    すべての面の向きについて、頂点オフセットと辺の法線を事前計算します。
+
+    Every orientation angle built by build_exact_positions is a multiple of
+    2π/L, where L = lcm(2, gons of the polyhedron): it starts at 0 or -π and
+    changes by multiples of 2π/gon and π. A face of the given gon at
+    orientation index k (angle 2πk/L) has its vertices at
+    center + table[(gon, k)][j], so no trigonometry is evaluated per face.
+    Orientation k + L/gon is orientation k with its vertex list rotated by
+    one, so only L/gon orientations per gon are computed.
+
+    build_exact_positions が作るすべての向きの角度は 2π/L（L = lcm(2, 多面体の角数)）の
+    倍数である（0 または -π から始まり、2π/gon と π の倍数ずつ変わる）。
+    向きのインデックス k（角度 2πk/L）の面の頂点は center + table[(gon, k)][j] であり、
+    面ごとに三角関数を評価しない。向き k + L/gon は向き k の頂点列を1つ回転したもの
+    であるため、角数ごとに L/gon 個の向きのみを計算する。
+
+    Args:
+        gon_list (list): Number of edges for each face
+
+    Returns:
+        dict: Read-only table with:
+            - orientations (int): L
+            - offsets (dict): (gon, k) -> [(dx, dy), ...], exact SymPy
+              expressions r*cos(θ_j), r*sin(θ_j) with θ_j = 2πk/L + π/gon + 2πj/gon
+            - numeric (dict): (gon, k) -> ([(dx, dy), ...], [(nx, ny), ...]),
+              float vertex offsets and outward unit edge normals (edge j runs
+              from vertex j to vertex j+1)
+    """
+    orientations = 2
+    for gon in set(gon_list):
+        orientations = orientations * gon // math.gcd(orientations, gon)
+
+    offsets = {}
+    numeric = {}
+    for gon in sorted(set(gon_list)):
+        r = _circumradius(gon)
+        period = orientations // gon
+        for k in range(period):
+            ang = 2 * pi * k / orientations
+            base = []
+            for j in range(gon):
+                theta = ang + pi / gon + 2 * pi * j / gon
+                base.append((r * cos(theta), r * sin(theta)))
+            base_numeric = [(float(dx), float(dy)) for dx, dy in base]
+            for shift in range(gon):
+                verts = base[shift:] + base[:shift]
+                verts_numeric = base_numeric[shift:] + base_numeric[:shift]
+                normals = []
+                for j in range(gon):
+                    (x1, y1), (x2, y2) = verts_numeric[j], verts_numeric[(j + 1) % gon]
+                    length = math.hypot(x2 - x1, y2 - y1)
+                    normals.append(((y2 - y1) / length, (x1 - x2) / length))
+                offsets[(gon, k + shift * period)] = verts
+                numeric[(gon, k + shift * period)] = (verts_numeric, normals)
+
+    return {"orientations": orientations, "offsets": offsets, "numeric": numeric}
+
+
+def _orientation_index(table, ang):
+    """
+    Orientation index k of an exact orientation angle (ang = 2πk/L modulo 2π).
+
+    厳密な向きの角度の向きインデックス k（ang = 2πk/L mod 2π）。
+    """
+    L = table["orientations"]
+    k = sympify(ang / pi) * L / 2
+    if not k.is_Integer:
+        raise ValueError(f"Orientation angle {ang} is not a multiple of 2*pi/{L}")
+    return int(k) % L
+
+
+def _get_vertices_of_face(table, gon, cx, cy, ang):
     """
     Compute exact vertices of a regular n-gon given center and orientation angle.
 
     中心座標と向きの角度から正 n 角形の厳密な頂点座標を計算します。
 
-    Ported from scripts/exact_overlap_checker.py: get_vertices_of_face()
+    Ported from scripts/exact_overlap_checker.py: get_vertices_of_face(); the
+    offsets r*cos(ang + π/n + 2πk/n), r*sin(...) come from the vertex table.
 
     Args:
+        table: Vertex table (see _build_vertex_table)
         gon: Number of sides
         cx, cy: Center coordinates (exact SymPy expressions)
         ang: Orientation angle in radians (exact SymPy expression)
 
     Returns:
-        list of tuples: [(x0, y0), (x1, y1), ...] with exact SymPy expressions
+        tuple: (vertices, shape)
+            vertices: [(x0, y0), (x1, y1), ...] with exact SymPy expressions
+            shape: (float vertices, outward unit edge normals) for
+                   _polygons_separated
     """
-    r = _circumradius(gon)
-    offset = pi / gon
-    vertices = []
-    for k in range(gon):
-        theta = ang + offset + 2 * pi * k / gon
-        xk = cx + r * cos(theta)
-        yk = cy + r * sin(theta)
-        vertices.append((xk, yk))
-    return vertices
+    k = _orientation_index(table, ang)
+    vertices = [(cx + dx, cy + dy) for dx, dy in table["offsets"][(gon, k)]]
+    offsets_numeric, normals = table["numeric"][(gon, k)]
+    fx, fy = float(cx), float(cy)
+    shape = ([(fx + dx, fy + dy) for dx, dy in offsets_numeric], normals)
+    return vertices, shape
 
 
 # ---------------------------------------------------------------------------
@@ -345,6 +431,51 @@ def _shares_vertex_chain_all(poly, face_ids, i, j):
     return len(common) > 0
 
 
+# ---------------------------------------------------------------------------
+# Polygon separation (numeric, separating axis)
+# 多角形の分離判定（数値、分離軸）
+# ---------------------------------------------------------------------------
+
+# Minimum gap along a separating axis for a float decision; float coordinates
+# of the exact positions are accurate to about 1e-14, so a larger gap is real
+# 浮動小数点で判断するための分離軸方向の最小の隙間。厳密座標の浮動小数点値は
+# 約 1e-14 の精度であるため、これより大きい隙間は実在する
+_SEPARATION_MARGIN = 1e-9
+
+
+def _polygons_separated(shape1, shape2):
+    """
+    Check if two convex polygons are clearly apart, by the separating axis theorem.
+
+    分離軸定理により、2つの凸多角形が明らかに離れているかを判定します。
+
+    The candidate axes are the precomputed edge normals of both polygons.
+    True means a gap larger than _SEPARATION_MARGIN along one of them, in
+    which case _polygons_overlap finds no intersection of any kind; False is
+    not a decision and the exact check must run.
+
+    候補となる軸は両多角形の事前計算された辺の法線。True はそのいずれかに沿って
+    _SEPARATION_MARGIN より大きい隙間があることを意味し、その場合 _polygons_overlap は
+    いかなる種別の交差も見つけない。False は判断ではなく、厳密な判定を実行する必要がある。
+
+    Args:
+        shape1, shape2: (float vertices, outward unit edge normals)
+
+    Returns:
+        bool: True if the polygons are separated by more than the margin
+    """
+    verts1, normals1 = shape1
+    verts2, normals2 = shape2
+    for verts, normals, other in ((verts1, normals1, verts2), (verts2, normals2, verts1)):
+        for (nx, ny), (px, py) in zip(normals, verts):
+            # Edge j lies on the line n . v = n . p_j; the polygon is behind it
+            # 辺 j は直線 n . v = n . p_j 上にあり、多角形はその内側にある
+            limit = nx * px + ny * py + _SEPARATION_MARGIN
+            if all(nx * x + ny * y > limit for x, y in other):
+                return True
+    return False
+
+
 # ---------------------------------------------------------------------------
 # Polygon overlap detection (hybrid numeric + exact)
 # 多角形の重なり検出（ハイブリッド数値＋厳密）
@@ -692,10 +823,12 @@ def check_record_overlap(poly, faces):
 
     # Build polygon vertices and face ID list
     polygons = []
+    shapes = []
     face_ids = []
     for (gon, face_id, cx, cy, ang) in exact_positions:
-        verts = _get_vertices_of_face(gon, cx, cy, ang)
+        verts, shape = _get_vertices_of_face(poly["vertex_table"], gon, cx, cy, ang)
         polygons.append(verts)
+        shapes.append(shape)
         face_ids.append(face_id)
 
     # Check if endpoint pair (first and last) is a valid candidate
@@ -706,6 +839,8 @@ def check_record_overlap(poly, faces):
         return False
 
     # Check endpoint overlap (first and last faces must overlap)
+    if _polygons_separated(shapes[0], shapes[-1]):
+        return False
     end_overlap, _end_kind = _polygons_overlap(polygons[0], polygons[-1])
 
     if not end_overlap:
@@ -718,6 +853,8 @@ def check_record_overlap(poly, faces):
                 continue  # skip endpoint pair (already verified)
             if _shares_vertex_chain_all(poly, face_ids, i, j):
                 continue  # skip topologically adjacent pairs
+            if _polygons_separated(shapes[i], shapes[j]):
+                continue  # clearly apart, no overlap of any kind
             spurious, _sp_kind = _polygons_overlap(polygons[i], polygons[j])
             if spurious:
                 return False  # spurious overlap found → remove record
@@ -762,10 +899,12 @@ def check_record_overlap_safe(poly, faces):
 
     # Build polygon vertices and face ID list
     polygons = []
+    shapes = []
     face_ids = []
     for (gon, face_id, cx, cy, ang) in exact_positions:
-        verts = _get_vertices_of_face(gon, cx, cy, ang)
+        verts, shape = _get_vertices_of_face(poly["vertex_table"], gon, cx, cy, ang)
         polygons.append(verts)
+        shapes.append(shape)
         face_ids.append(face_id)
 
     # Check if endpoint pair is a valid candidate
@@ -779,7 +918,10 @@ def check_record_overlap_safe(poly, faces):
         })
 
     # Check endpoint overlap with classification
-    end_overlap, end_kind = _polygons_overlap(polygons[0], polygons[-1])
+    if _polygons_separated(shapes[0], shapes[-1]):
+        end_overlap, end_kind = False, None
+    else:
+        end_overlap, end_kind = _polygons_overlap(polygons[0], polygons[-1])
 
     if not end_overlap:
         return (False, {
@@ -797,6 +939,8 @@ def check_record_overlap_safe(poly, faces):
                 continue
             if _shares_vertex_chain_all(poly, face_ids, i, j):
                 continue
+            if _polygons_separated(shapes[i], shapes[j]):
+                continue
             overlap, kind = _polygons_overlap(polygons[i], polygons[j])
             if overlap:
                 ok = False
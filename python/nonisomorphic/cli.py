@@ -41,6 +41,14 @@ def create_parser():
         help="Path to polyhedron data directory (e.g., data/polyhedra/archimedean/s04)"
     )
     
+    run_parser.add_argument(
+        "--max-circle-gap",
+        type=float,
+        default=None,
+        help="Keep only records whose endpoint_slack.circle_gap is below this value "
+             "(requires raw.jsonl generated with --tag-slack)"
+    )
+    
     return parser
 
 
@@ -109,6 +117,8 @@ def main():
             print(f"Input (raw.jsonl): {raw_jsonl_path}")
             print(f"Polyhedron structure: {polyhedron_json_path}")
             print(f"Output (noniso.jsonl): {noniso_jsonl_path}")
+            if args.max_circle_gap is not None:
+                print(f"Circle gap filter: < {args.max_circle_gap}")
             print("")
             
             # Remove isomorphic duplicates
@@ -117,7 +127,8 @@ def main():
             num_input, num_output = remove_isomorphic_duplicates(
                 raw_jsonl_path,
                 polyhedron_json_path,
-                noniso_jsonl_path
+                noniso_jsonl_path,
+                max_circle_gap=args.max_circle_gap
             )
             
             print("")
@@ -203,7 +203,8 @@ def canonical_key(seq):
     return min(tuple(a), tuple(b), tuple(c), tuple(d))
 
 
-def remove_isomorphic_duplicates(raw_jsonl_path, polyhedron_json_path, output_jsonl_path):
+def remove_isomorphic_duplicates(raw_jsonl_path, polyhedron_json_path, output_jsonl_path,
+                                 max_circle_gap=None):
     """
     Removes isomorphic duplicates from raw.jsonl and writes to noniso.jsonl.
     
@@ -213,6 +214,13 @@ def remove_isomorphic_duplicates(raw_jsonl_path, polyhedron_json_path, output_js
         raw_jsonl_path (Path): Path to raw.jsonl (Phase 1 output)
         polyhedron_json_path (Path): Path to polyhedron.json (polyhedron structure)
         output_jsonl_path (Path): Path to noniso.jsonl (Phase 2 output)
+        max_circle_gap (float or None): If given, keep only records whose
+            endpoint_slack.circle_gap is below this value. This reproduces a
+            Phase 1 run with a tighter emit tolerance from a raw.jsonl that was
+            generated with --emit-buffer and --tag-slack.
+            指定された場合、endpoint_slack.circle_gap がこの値未満のレコードのみを
+            残す。--emit-buffer と --tag-slack で生成した raw.jsonl から、
+            より厳しい出力許容値での Phase 1 実行結果を再現する。
     
     Returns:
         tuple: (num_input_records, num_output_records)
@@ -269,6 +277,18 @@ def remove_isomorphic_duplicates(raw_jsonl_path, polyhedron_json_path, output_js
             except json.JSONDecodeError as e:
                 raise ValueError(f"JSON parse error at line {line_num}: {e}")
             
+            # Filter by endpoint slack (tighter emit tolerance)
+            # 端点スラックで絞り込む（より厳しい出力許容値）
+            if max_circle_gap is not None:
+                slack = record.get("endpoint_slack")
+                if slack is None:
+                    raise ValueError(
+                        f"Record at line {line_num} has no endpoint_slack; "
+                        f"run Phase 1 with --tag-slack to filter by circle gap"
+                    )
+                if not slack["circle_gap"] < max_circle_gap:
+                    continue
+            
             # Extract faces from record
             # レコードから faces を抽出
             faces = record.get("faces", [])
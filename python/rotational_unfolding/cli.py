@@ -49,6 +49,48 @@ def create_parser():
         help="Symmetry mode (default: auto)"
     )
     
+    run_parser.add_argument(
+        "--emit-buffer",
+        type=float,
+        default=None,
+        help="Emit tolerance added to the circumradius sum (default: C++ default, 0.01)"
+    )
+    
+    run_parser.add_argument(
+        "--tag-slack",
+        action="store_true",
+        default=False,
+        help="Tag each record with its endpoint slack (circle gap)"
+    )
+    
+    run_parser.add_argument(
+        "--threads",
+        type=int,
+        default=None,
+        help="Number of C++ worker threads (default: CPUs allowed by affinity and cgroup quota)"
+    )
+    
+    run_parser.add_argument(
+        "--pin",
+        action="store_true",
+        default=False,
+        help="Pin C++ worker threads to CPUs, node by node, with NUMA-local scheduling"
+    )
+    
+    run_parser.add_argument(
+        "--validate",
+        action="store_true",
+        default=False,
+        help="Replay-validate raw.jsonl after the run (requires cpp/rotunfold-validate)"
+    )
+    
+    run_parser.add_argument(
+        "--roots-subset",
+        default=None,
+        help="Re-run only these root pairs and splice them into the existing raw.jsonl "
+             "(comma-separated root indices, ranges like 3-7, or FACE:EDGE pairs)"
+    )
+    
     return parser
 
 
@@ -61,6 +103,9 @@ def main():
     Example usage:
         python -m rotational_unfolding run --poly data/polyhedra/archimedean/s05
         python -m rotational_unfolding run --poly data/polyhedra/archimedean/s01 --symmetric on
+        python -m rotational_unfolding run --poly data/polyhedra/johnson/n20 --emit-buffer 0.1 --tag-slack
+        python -m rotational_unfolding run --poly data/polyhedra/johnson/n20 --validate
+        python -m rotational_unfolding run --poly data/polyhedra/johnson/n20 --roots-subset 4,10-12
     
     Output location:
         All output is written to output/<poly_path>/
@@ -81,7 +126,13 @@ def main():
         try:
             success = run_rotational_unfolding(
                 poly_id=args.poly,
-                symmetric_mode=args.symmetric
+                symmetric_mode=args.symmetric,
+                emit_buffer=args.emit_buffer,
+                tag_slack=args.tag_slack,
+                threads=args.threads,
+                validate=args.validate,
+                roots_subset=args.roots_subset,
+                pin=args.pin
             )
             sys.exit(0 if success else 1)
         except Exception as e:
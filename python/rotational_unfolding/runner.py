@@ -6,12 +6,16 @@ Handles:
 - C++ binary invocation via subprocess
 - raw.jsonl generation (canonical output per polyhedron)
 - run.json generation (experiment metadata)
+- Cost model location (per-root run history shared by all polyhedra)
+- Streaming records through a shared-memory ring (fused pipelines)
 
 実行ロジックを提供：
 - 多面体データのパス解決
 - C++ バイナリのサブプロセス呼び出し
 - raw.jsonl 生成（多面体ごとの正規出力）
 - run.json 生成（実験メタデータ）
+- コストモデルの配置（全多面体で共有する root pair ごとの実行履歴）
+- 共有メモリリングによるレコードのストリーミング（結合したパイプライン）
 """
 
 import json
@@ -23,23 +27,26 @@ from pathlib import Path
 
 from poly_resolve import find_repo_root, resolve_poly
 
+from .shm_ring import DEFAULT_CAPACITY, ShmRing, ShmRingError
 
-def find_cpp_binary(repo_root):
+
+def find_cpp_binary(repo_root, name="rotunfold"):
     """
-    Locates the C++ binary (rotunfold) in the repository.
+    Locates a C++ binary (rotunfold by default) in the repository.
     
-    リポジトリ内の C++ バイナリ（rotunfold）を見つける。
+    リポジトリ内の C++ バイナリ（既定では rotunfold）を見つける。
     
     Args:
         repo_root (Path): Repository root path.
+        name (str): Binary name (e.g., "rotunfold", "rotunfold-validate").
     
     Returns:
-        Path: Absolute path to the rotunfold binary.
+        Path: Absolute path to the binary.
     
     Raises:
         FileNotFoundError: If the binary does not exist.
     """
-    cpp_binary = repo_root / "cpp" / "rotunfold"
+    cpp_binary = repo_root / "cpp" / name
     
     if not cpp_binary.is_file():
         raise FileNotFoundError(
@@ -51,6 +58,26 @@ def find_cpp_binary(repo_root):
 
 
 
+def find_cost_model(repo_root):
+    """
+    Returns the path of the cost model shared by all Phase 1 runs.
+    
+    すべての Phase 1 実行で共有するコストモデルのパスを返す。
+    
+    The file records per-root node counts and wall times keyed by the
+    polyhedron content hash. It is machine-specific and not version-controlled.
+    ファイルは多面体の内容ハッシュをキーとして root pair ごとのノード数と
+    経過時間を記録する。マシン固有であり、バージョン管理はしない。
+    
+    Args:
+        repo_root (Path): Repository root path.
+    
+    Returns:
+        Path: Path to output/cost_model.json (may not exist yet).
+    """
+    return repo_root / "output" / "cost_model.json"
+
+
 def generate_run_id():
     """
     Generates a run ID based on timestamp (for run.json metadata only).
@@ -112,7 +139,11 @@ def create_run_metadata(
     poly_name,
     symmetric_mode,
     raw_jsonl_path,
-    num_records
+    num_records,
+    emit_buffer=None,
+    tag_slack=False,
+    roots_subset=None,
+    index_path=None
 ):
     """
     Creates the run.json metadata structure.
@@ -134,6 +165,10 @@ def create_run_metadata(
         symmetric_mode (str): Symmetry mode requested.
         raw_jsonl_path (Path): Path to raw.jsonl output.
         num_records (int): Number of records written to raw.jsonl.
+        emit_buffer (float or None): Emit tolerance passed to C++ (None = default).
+        tag_slack (bool): Whether records were tagged with endpoint slack.
+        roots_subset (str or None): Root pairs re-run and spliced (None = all).
+        index_path (Path or None): Path to the byte-offset index of raw.jsonl.
     
     Returns:
         dict: run.json metadata structure.
@@ -203,7 +238,10 @@ def create_run_metadata(
                 "mode_requested": symmetric_mode,
                 "symmetric_used": symmetric_used,
                 **({"auto_basis": auto_basis} if auto_basis else {})
-            }
+            },
+            **({"emit_buffer": emit_buffer} if emit_buffer is not None else {}),
+            **({"tag_slack": True} if tag_slack else {}),
+            **({"roots_subset": roots_subset} if roots_subset else {})
         },
         "outputs": {
             "raw_jsonl": {
@@ -211,12 +249,49 @@ def create_run_metadata(
                 "schema_version": 1,
                 "record_type": "partial_unfolding",
                 "num_records_written": num_records
-            }
+            },
+            **({"raw_index": {
+                "path": str(index_path.resolve()),
+                "schema_version": 1,
+                "record_type": "output_index"
+            }} if index_path is not None and index_path.is_file() else {})
         }
     }
 
 
-def run_rotational_unfolding(poly_id, symmetric_mode):
+def validate_raw_jsonl(repo_root, polyhedron_json, raw_jsonl_path, threads=None):
+    """
+    Replays every record of raw.jsonl with the C++ validator.
+    
+    C++ 検証器で raw.jsonl のすべてのレコードを再生検証する。
+    
+    Args:
+        repo_root (Path): Repository root path.
+        polyhedron_json (Path): Path to polyhedron.json.
+        raw_jsonl_path (Path): Path to raw.jsonl.
+        threads (int or None): Number of validator threads (None = all CPUs).
+    
+    Returns:
+        bool: True if every record is valid, False otherwise.
+    """
+    validator = find_cpp_binary(repo_root, "rotunfold-validate")
+    argv = [
+        str(validator),
+        "--polyhedron", str(polyhedron_json),
+        "--limit", "10",
+        str(raw_jsonl_path)
+    ]
+    if threads is not None:
+        argv += ["--threads", str(threads)]
+    
+    print("Validating raw.jsonl...")
+    print(f"Command: {' '.join(argv)}")
+    result = subprocess.run(argv, stdout=sys.stdout, stderr=sys.stderr, check=False)
+    return result.returncode == 0
+
+
+def run_rotational_unfolding(poly_id, symmetric_mode, emit_buffer=None, tag_slack=False,
+                             threads=None, validate=False, roots_subset=None, pin=False):
     """
     Runs rotational unfolding for a specified polyhedron.
     
@@ -225,23 +300,34 @@ def run_rotational_unfolding(poly_id, symmetric_mode):
     Args:
         poly_id (str): Path to polyhedron data directory (e.g., "data/polyhedra/archimedean/s05").
         symmetric_mode (str): Symmetry mode (auto, on, or off).
+        emit_buffer (float or None): Emit tolerance (None = C++ default).
+        tag_slack (bool): Tag each record with its endpoint slack.
+        threads (int or None): Number of C++ worker threads (None = CPUs available).
+        validate (bool): Replay-validate raw.jsonl after the run.
+        roots_subset (str or None): Re-run only these root pairs (C++ --roots-subset
+            syntax) and splice them into the existing raw.jsonl.
+        pin (bool): Pin C++ worker threads to CPUs (NUMA-local scheduling).
     
     Returns:
-        bool: True if successful, False otherwise.
+        bool: True if successful (and valid, when validate is set), False otherwise.
     
     Workflow:
         1. Resolve paths (polyhedron data, C++ binary)
         2. Create canonical output directory: output/<poly_path>/
-        3. Invoke C++ binary to generate raw.jsonl
+        3. Invoke C++ binary to generate raw.jsonl and its index
+           (or to splice a subset of root pairs into the existing raw.jsonl)
         4. Generate run.json metadata
-        5. Report results
+        5. Validate raw.jsonl (if requested)
+        6. Report results
     
     手順:
         1. パス解決（多面体データ、C++ バイナリ）
         2. 正規出力ディレクトリを作成: output/<poly_path>/
-        3. C++ バイナリを呼び出して raw.jsonl を生成
+        3. C++ バイナリを呼び出して raw.jsonl とその索引を生成
+           （または root pair の一部を既存の raw.jsonl に結合）
         4. run.json メタデータを生成
-        5. 結果の報告
+        5. raw.jsonl を検証（指定された場合）
+        6. 結果の報告
     
     Output Convention:
         - Output goes to: output/<poly_path>/
@@ -287,6 +373,10 @@ def run_rotational_unfolding(poly_id, symmetric_mode):
     
     raw_jsonl_path = output_dir / "raw.jsonl"
     run_json_path = output_dir / "run.json"
+    raw_index_path = output_dir / "raw.index.json"
+    
+    if roots_subset and not raw_jsonl_path.is_file():
+        raise FileNotFoundError(f"--roots-subset needs an existing raw.jsonl: {raw_jsonl_path}")
     
     print(f"Output directory: {output_dir}")
     print(f"raw.jsonl: {raw_jsonl_path}")
@@ -299,8 +389,20 @@ def run_rotational_unfolding(poly_id, symmetric_mode):
         "--polyhedron", str(polyhedron_json),
         "--roots", str(root_pairs_json),
         "--symmetric", symmetric_mode,
-        "--out", str(raw_jsonl_path)
+        "--out", str(raw_jsonl_path),
+        "--index", str(raw_index_path),
+        "--cost-model", str(find_cost_model(repo_root))
     ]
+    if threads is not None:
+        argv += ["--threads", str(threads)]
+    if pin:
+        argv.append("--pin")
+    if emit_buffer is not None:
+        argv += ["--emit-buffer", repr(emit_buffer)]
+    if tag_slack:
+        argv.append("--tag-slack")
+    if roots_subset:
+        argv += ["--roots-subset", roots_subset]
     
     print("Invoking C++ binary...")
     print(f"Command: {' '.join(argv)}")
@@ -356,7 +458,11 @@ def run_rotational_unfolding(poly_id, symmetric_mode):
         poly_name=poly_name,
         symmetric_mode=symmetric_mode,
         raw_jsonl_path=raw_jsonl_path,
-        num_records=num_records
+        num_records=num_records,
+        emit_buffer=emit_buffer,
+        tag_slack=tag_slack,
+        roots_subset=roots_subset,
+        index_path=raw_index_path
     )
     
     with open(run_json_path, "w", encoding="utf-8") as f:
@@ -365,6 +471,87 @@ def run_rotational_unfolding(poly_id, symmetric_mode):
     
     print(f"run.json written: {run_json_path}")
     print("")
+    
+    if validate and exit_code == 0:
+        if not validate_raw_jsonl(repo_root, polyhedron_json, raw_jsonl_path, threads):
+            print("Error: raw.jsonl failed validation.", file=sys.stderr)
+            return False
+        print("")
+    
     print("Done.")
     
     return exit_code == 0
+
+
+def stream_rotational_unfolding(poly_id, symmetric_mode, emit_buffer=None, tag_slack=False,
+                                threads=None, pin=False, capacity=DEFAULT_CAPACITY):
+    """
+    Runs rotational unfolding and yields its records through a shared-memory
+    ring, without writing raw.jsonl or run.json.
+    
+    回転展開を実行し、raw.jsonl や run.json を書き込まずに、共有メモリリングを
+    通してレコードを返す。
+    
+    Args:
+        poly_id (str): Path to polyhedron data directory (e.g., "data/polyhedra/archimedean/s05").
+        symmetric_mode (str): Symmetry mode (auto, on, or off).
+        emit_buffer (float or None): Emit tolerance (None = C++ default).
+        tag_slack (bool): Tag each record with its endpoint slack.
+        threads (int or None): Number of C++ worker threads (None = CPUs available).
+        pin (bool): Pin C++ worker threads to CPUs (NUMA-local scheduling).
+        capacity (int): Ring size in bytes.
+    
+    Yields:
+        RingRecord: Records in raw.jsonl order, each valid until the next one
+            is requested (see shm_ring.RingRecord).
+    
+    Raises:
+        ShmRingError: If rotunfold fails or exits before ending the stream.
+    
+    Notes:
+        - The fast path for pipelines fused on one machine: records are read
+          in place from shared memory, with no JSON formatting, pipe copies,
+          or parsing
+        - Stopping the iteration early stops rotunfold
+        - The cost model is used and updated as in run_rotational_unfolding
+    
+    注記:
+        - 1台のマシン上で結合したパイプライン向けの高速経路: レコードは共有メモリから
+          その場で読まれ、JSON の書式化、パイプのコピー、解析は行われない
+        - 反復を途中でやめると rotunfold も停止する
+        - コストモデルは run_rotational_unfolding と同様に使用・更新される
+    """
+    repo_root = find_repo_root()
+    data_dir, _, _, _ = resolve_poly(repo_root, poly_id)
+    argv = [
+        str(find_cpp_binary(repo_root)),
+        "--polyhedron", str(data_dir / "polyhedron.json"),
+        "--roots", str(data_dir / "root_pairs.json"),
+        "--symmetric", symmetric_mode,
+        "--cost-model", str(find_cost_model(repo_root))
+    ]
+    if threads is not None:
+        argv += ["--threads", str(threads)]
+    if pin:
+        argv.append("--pin")
+    if emit_buffer is not None:
+        argv += ["--emit-buffer", repr(emit_buffer)]
+    if tag_slack:
+        argv.append("--tag-slack")
+    
+    with ShmRing(capacity) as ring:
+        process = subprocess.Popen(
+            argv + ["--shm-ring", ring.argument],
+            pass_fds=ring.pass_fds,
+            stdout=subprocess.DEVNULL,
+            stderr=sys.stderr
+        )
+        completed = False
+        try:
+            yield from ring.records(process)
+            completed = True
+        finally:
+            ring.close()
+            exit_code = process.wait()
+        if completed and exit_code != 0:
+            raise ShmRingError(f"C++ process exited with code: {exit_code}")
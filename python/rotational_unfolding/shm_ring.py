@@ -0,0 +1,313 @@
+"""
+Shared-memory ring reader for rotunfold --shm-ring.
+
+Handles:
+- Creating the ring (a memfd and two eventfds) shared with a rotunfold child
+- Reading binary records in place with mmap and struct, in raw.jsonl order
+- Converting records to raw.jsonl dicts and lines
+
+rotunfold --shm-ring の共有メモリリングの読み手：
+- rotunfold の子プロセスと共有するリング（memfd 1つと eventfd 2つ）の作成
+- mmap と struct によるバイナリレコードのその場での読み取り（raw.jsonl の順）
+- レコードの raw.jsonl の辞書・行への変換
+
+The layout and protocol are defined in cpp/include/ShmRing.hpp and
+cpp/include/BinaryRecord.hpp; the constants below must match them.
+レイアウトとプロトコルは cpp/include/ShmRing.hpp と cpp/include/BinaryRecord.hpp で
+定義されており、以下の定数はそれらと一致しなければならない。
+"""
+
+import mmap
+import os
+import select
+import struct
+
+MAGIC = b"RUFRING1"
+VERSION = 1
+DEFAULT_CAPACITY = 64 << 20
+MIN_CAPACITY = 1 << 20
+
+PRODUCER_RUNNING = 0
+PRODUCER_COMPLETE = 1
+PRODUCER_FAILED = 2
+
+FLAG_SYMMETRIC_USED = 1
+FLAG_HAS_SLACK = 2
+
+# Offsets of the control fields / 制御フィールドのオフセット
+_WRITE_POS = 64
+_READ_POS = 128
+_PRODUCER_STATE = 192
+_CONSUMER_CLOSED = 196
+_CONSUMER_WAITING = 256
+_PRODUCER_WAITING = 320
+
+_U32 = struct.Struct("<I")
+_U64 = struct.Struct("<Q")
+_RECORD_HEADER = struct.Struct("<IiiHBBd")  # size, base_face, base_edge, num_faces, flags, reserved, circle_gap
+_FACE = struct.Struct("<iii4xddd")          # face_id, gon, edge_id, (reserved), x, y, angle_deg
+
+# Waits time out so that a missed wakeup only costs latency
+# 待機はタイムアウトするため、起床を取り逃しても遅延が増えるだけ
+_WAIT_SECONDS = 0.05
+
+
+class ShmRingError(RuntimeError):
+    """Raised when the ring or the producer fails. / リングまたは生産者が失敗した場合に送出される。"""
+
+
+class RingRecord:
+    """
+    One binary record, read in place from the ring.
+
+    リングからその場で読む1つのバイナリレコード。
+
+    Valid only until the next record is requested from the ring; use
+    to_dict() or to_jsonl() to keep it.
+    リングから次のレコードを要求するまでのみ有効。保持するには to_dict() または
+    to_jsonl() を使う。
+    """
+
+    __slots__ = ("_buffer", "_offset", "base_face", "base_edge", "num_faces", "flags", "_circle_gap")
+
+    def __init__(self, buffer, offset):
+        self._buffer = buffer
+        self._offset = offset
+        (_, self.base_face, self.base_edge, self.num_faces, self.flags, _,
+         self._circle_gap) = _RECORD_HEADER.unpack_from(buffer, offset)
+
+    @property
+    def symmetric_used(self):
+        return bool(self.flags & FLAG_SYMMETRIC_USED)
+
+    @property
+    def circle_gap(self):
+        """Endpoint slack, or None if the record is not tagged. / 端点スラック。付加されていなければ None。"""
+        return self._circle_gap if self.flags & FLAG_HAS_SLACK else None
+
+    def faces(self):
+        """
+        Returns the faces as (face_id, gon, edge_id, x, y, angle_deg) tuples.
+
+        面を (face_id, gon, edge_id, x, y, angle_deg) のタプルとして返す。
+        """
+        start = self._offset + _RECORD_HEADER.size
+        return [_FACE.unpack_from(self._buffer, start + i * _FACE.size)
+                for i in range(self.num_faces)]
+
+    def to_dict(self):
+        """
+        Returns the record as the dict of its raw.jsonl line.
+
+        レコードを raw.jsonl の行の辞書として返す。
+        """
+        record = {
+            "schema_version": 1,
+            "record_type": "partial_unfolding",
+            "base_pair": {"base_face": self.base_face, "base_edge": self.base_edge},
+            "symmetric_used": self.symmetric_used,
+            "faces": [
+                {"face_id": f, "gon": g, "edge_id": e, "x": x, "y": y, "angle_deg": a}
+                for f, g, e, x, y, a in self.faces()
+            ]
+        }
+        if self.circle_gap is not None:
+            record["endpoint_slack"] = {"circle_gap": self.circle_gap}
+        return record
+
+    def to_jsonl(self):
+        """
+        Returns the raw.jsonl line of the record (byte-identical to rotunfold --out).
+
+        レコードの raw.jsonl の行を返す（rotunfold --out とバイト単位で同一）。
+        """
+        faces = ",".join(
+            '{"face_id":%d,"gon":%d,"edge_id":%d,"x":%.6f,"y":%.6f,"angle_deg":%.6f}' % face
+            for face in self.faces()
+        )
+        line = ('{"schema_version":1,"record_type":"partial_unfolding",'
+                '"base_pair":{"base_face":%d,"base_edge":%d},"symmetric_used":%s,"faces":[%s]'
+                % (self.base_face, self.base_edge, "true" if self.symmetric_used else "false", faces))
+        if self.circle_gap is not None:
+            line += ',"endpoint_slack":{"circle_gap":%.6f}' % self.circle_gap
+        return line + "}\n"
+
+
+class ShmRing:
+    """
+    Consumer side of a shared-memory ring.
+
+    共有メモリリングの読み手側。
+
+    Usage:
+        with ShmRing() as ring:
+            proc = subprocess.Popen([rotunfold, ..., "--shm-ring", ring.argument],
+                                    pass_fds=ring.pass_fds)
+            for record in ring.records(proc):
+                ...
+            proc.wait()
+    """
+
+    def __init__(self, capacity=DEFAULT_CAPACITY):
+        """
+        Creates a ring of at least capacity bytes (rounded up to whole pages,
+        at least MIN_CAPACITY).
+
+        少なくとも capacity バイト（ページ単位に切り上げ、MIN_CAPACITY 以上）の
+        リングを作成する。
+        """
+        page = mmap.PAGESIZE
+        capacity = max(capacity, MIN_CAPACITY)
+        capacity = (capacity + page - 1) // page * page
+
+        self.mem_fd = os.memfd_create("rotunfold-ring", 0)
+        self.data_fd = os.eventfd(0, os.EFD_NONBLOCK)
+        self.space_fd = os.eventfd(0, os.EFD_NONBLOCK)
+        os.ftruncate(self.mem_fd, page + capacity)
+        self._map = mmap.mmap(self.mem_fd, page + capacity)
+        struct.pack_into("<8sIIQ", self._map, 0, MAGIC, VERSION, page, capacity)
+
+        self.data_offset = page
+        self.capacity = capacity
+        self.failed = False
+        self._position = 0   # Start of the current record / 現在のレコードの先頭
+        self._published = 0  # Last read_pos published / 最後に公開した read_pos
+        self._pending = 0    # Size of the record handed out last / 最後に渡したレコードのサイズ
+        self._closed = False
+
+    @property
+    def pass_fds(self):
+        """Descriptors the rotunfold process must inherit. / rotunfold プロセスが継承すべき記述子。"""
+        return (self.mem_fd, self.data_fd, self.space_fd)
+
+    @property
+    def argument(self):
+        """Value of rotunfold --shm-ring. / rotunfold --shm-ring の値。"""
+        return f"{self.mem_fd},{self.data_fd},{self.space_fd}"
+
+    def records(self, process=None):
+        """
+        Yields the records of the ring in order, until the producer ends the stream.
+
+        生産者がストリームを終了するまで、リングのレコードを順に返す。
+
+        Args:
+            process (subprocess.Popen or None): Producer process, checked while
+                waiting so that a crashed producer is detected.
+
+        Yields:
+            RingRecord: Valid until the next record is requested.
+
+        Raises:
+            ShmRingError: If the producer fails or exits without ending the stream.
+        """
+        while True:
+            record = self._next(process)
+            if record is None:
+                return
+            yield record
+
+    def close(self):
+        """
+        Stops reading and releases the ring. A producer still writing then fails.
+
+        読み取りをやめ、リングを解放する。まだ書き込み中の生産者は失敗する。
+        """
+        if self._closed:
+            return
+        self._closed = True
+        self._position += self._pending
+        self._pending = 0
+        self._release()
+        _U32.pack_into(self._map, _CONSUMER_CLOSED, 1)
+        _notify(self.space_fd)
+        self._map.close()
+        for fd in self.pass_fds:
+            os.close(fd)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc, tb):
+        self.close()
+
+    def _load(self, offset, field=_U64):
+        return field.unpack_from(self._map, offset)[0]
+
+    def _release(self):
+        """Publishes read_pos, waking the producer if it waits for space."""
+        if self._position == self._published:
+            return
+        self._published = self._position
+        _U64.pack_into(self._map, _READ_POS, self._position)
+        if self._load(_PRODUCER_WAITING, _U32):
+            _notify(self.space_fd)
+
+    def _fail(self, message):
+        self.failed = True
+        raise ShmRingError(message)
+
+    def _next(self, process):
+        """Returns the next record, or None at the end of the stream."""
+        mm = self._map
+        capacity = self.capacity
+        self._position += self._pending
+        self._pending = 0
+        if self._position - self._published >= capacity // 8:
+            self._release()
+
+        while True:
+            written = self._load(_WRITE_POS)
+            available = written - self._position
+            offset = self.data_offset + self._position % capacity
+            if available >= 4:
+                size = self._load(offset, _U32)
+                if size < _RECORD_HEADER.size or size % 8 != 0 or size >= capacity:
+                    self._fail(f"Invalid record size in shared-memory ring: {size}")
+                if available >= size:
+                    end = offset + size
+                    if end <= len(mm):
+                        record = RingRecord(mm, offset)
+                    else:
+                        # The record wraps around the end of the ring
+                        # レコードがリングの末尾で折り返している
+                        record = RingRecord(mm[offset:] + mm[self.data_offset:end - capacity], 0)
+                    self._pending = size
+                    return record
+
+            state = self._load(_PRODUCER_STATE, _U32)
+            if state != PRODUCER_RUNNING:
+                if self._load(_WRITE_POS) != written:
+                    continue
+                if state == PRODUCER_COMPLETE and available == 0:
+                    self._release()
+                    return None
+                self._fail("Shared-memory ring ended inside a record"
+                           if state == PRODUCER_COMPLETE else "Producer failed")
+            if process is not None and process.poll() is not None:
+                if self._load(_WRITE_POS) != written or self._load(_PRODUCER_STATE, _U32) != state:
+                    continue
+                self._fail("Producer exited without ending the shared-memory ring")
+
+            self._release()
+            _U32.pack_into(mm, _CONSUMER_WAITING, 1)
+            if (self._load(_WRITE_POS) == written
+                    and self._load(_PRODUCER_STATE, _U32) == PRODUCER_RUNNING):
+                _wait(self.data_fd)
+            _U32.pack_into(mm, _CONSUMER_WAITING, 0)
+
+
+def _notify(fd):
+    try:
+        os.eventfd_write(fd, 1)
+    except BlockingIOError:
+        pass  # A full counter already wakes the reader / 満杯のカウンタはすでに起床させる
+
+
+def _wait(fd):
+    ready, _, _ = select.select([fd], [], [], _WAIT_SECONDS)
+    if ready:
+        try:
+            os.eventfd_read(fd)
+        except BlockingIOError:
+            pass
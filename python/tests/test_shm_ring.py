@@ -0,0 +1,164 @@
+"""
+Tests for the shared-memory ring handoff (rotunfold --shm-ring).
+
+Checks that records read from the ring convert to the exact bytes of
+rotunfold --out, and that a consumer closing the ring early stops rotunfold
+promptly, instead of letting it search every remaining root pair.
+
+共有メモリのリングによる受け渡し（rotunfold --shm-ring）のテスト。
+
+リングから読んだレコードが rotunfold --out と完全に同じバイト列に変換される
+こと、および読み手がリングを早期に閉じると、rotunfold が残りのすべての
+root pair を探索するのではなく、すぐに停止することを確認する。
+
+Usage:
+    cd cpp && make
+    PYTHONPATH=python python -m unittest discover -s python/tests
+"""
+
+import subprocess
+import tempfile
+import time
+import unittest
+from pathlib import Path
+
+from poly_resolve import find_repo_root
+from rotational_unfolding.runner import find_cpp_binary
+from rotational_unfolding.shm_ring import MIN_CAPACITY, ShmRing, _FACE, _RECORD_HEADER
+
+# 90 root pairs; a full run takes seconds, far longer than the stop limit
+# 90 個の root pair。完全な実行には数秒かかり、停止までの上限よりはるかに長い
+POLY_DIR = "data/polyhedra/johnson/n20"
+
+# Longest time rotunfold may take to exit after the ring is closed
+# リングを閉じてから rotunfold が終了するまでの最長時間
+STOP_LIMIT_S = 1.0
+
+# Emit buffer for the byte-identity test: about 1.4 MiB of binary records,
+# so the stream wraps around a MIN_CAPACITY ring
+# バイト単位の一致テスト用の emit buffer。バイナリレコードは約 1.4 MiB になり、
+# MIN_CAPACITY のリングの末尾で折り返す
+WRAP_EMIT_BUFFER = "0.5"
+
+
+class ByteIdentityTest(unittest.TestCase):
+
+    def setUp(self):
+        self.repo_root = find_repo_root()
+        try:
+            self.binary = find_cpp_binary(self.repo_root)
+        except FileNotFoundError as e:
+            self.skipTest(str(e))
+
+    def _check_identical(self, options):
+        """
+        Runs rotunfold once with --out and once with --shm-ring, and checks
+        that the ring records converted with to_jsonl() equal the file.
+
+        rotunfold を --out と --shm-ring でそれぞれ1回実行し、to_jsonl() で
+        変換したリングのレコードがファイルと一致することを確認する。
+        """
+        data_dir = self.repo_root / POLY_DIR
+        argv = [
+            str(self.binary),
+            "--polyhedron", str(data_dir / "polyhedron.json"),
+            "--roots", str(data_dir / "root_pairs.json"),
+            "--threads", "4",
+            "--emit-buffer", WRAP_EMIT_BUFFER
+        ] + options
+
+        with tempfile.TemporaryDirectory() as tmp:
+            out_path = Path(tmp) / "raw.jsonl"
+            subprocess.run(argv + ["--out", str(out_path)], check=True,
+                           stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+            expected = out_path.read_bytes()
+
+        lines = []
+        streamed = 0
+        with ShmRing(MIN_CAPACITY) as ring:
+            process = subprocess.Popen(
+                argv + ["--shm-ring", ring.argument],
+                pass_fds=ring.pass_fds,
+                stdout=subprocess.DEVNULL,
+                stderr=subprocess.DEVNULL
+            )
+            try:
+                for record in ring.records(process):
+                    lines.append(record.to_jsonl())
+                    streamed += _RECORD_HEADER.size + record.num_faces * _FACE.size
+                self.assertEqual(process.wait(timeout=60), 0)
+            finally:
+                if process.poll() is None:
+                    process.kill()
+                    process.wait()
+            capacity = ring.capacity
+
+        # Records must have wrapped around the end of the ring
+        # レコードがリングの末尾で折り返していなければならない
+        self.assertGreater(streamed, capacity)
+        self.assertEqual("".join(lines).encode("utf-8"), expected)
+
+    def test_identical_without_slack(self):
+        self._check_identical([])
+
+    def test_identical_with_slack(self):
+        self._check_identical(["--tag-slack"])
+
+
+class EarlyCloseTest(unittest.TestCase):
+
+    def setUp(self):
+        self.repo_root = find_repo_root()
+        try:
+            self.binary = find_cpp_binary(self.repo_root)
+        except FileNotFoundError as e:
+            self.skipTest(str(e))
+
+    def _close_after_records(self, threads, num_records=3):
+        """
+        Reads num_records records, closes the ring, and returns the exit code
+        of rotunfold and the seconds it took to exit.
+
+        num_records 個のレコードを読んでリングを閉じ、rotunfold の終了コードと
+        終了までにかかった秒数を返す。
+        """
+        data_dir = self.repo_root / POLY_DIR
+        argv = [
+            str(self.binary),
+            "--polyhedron", str(data_dir / "polyhedron.json"),
+            "--roots", str(data_dir / "root_pairs.json"),
+            "--threads", str(threads)
+        ]
+        with ShmRing() as ring:
+            process = subprocess.Popen(
+                argv + ["--shm-ring", ring.argument],
+                pass_fds=ring.pass_fds,
+                stdout=subprocess.DEVNULL,
+                stderr=subprocess.DEVNULL
+            )
+            try:
+                records = ring.records(process)
+                for _ in range(num_records):
+                    next(records)
+                ring.close()
+                start = time.monotonic()
+                exit_code = process.wait(timeout=60)
+                return exit_code, time.monotonic() - start
+            finally:
+                if process.poll() is None:
+                    process.kill()
+                    process.wait()
+
+    def test_close_stops_serial_run(self):
+        exit_code, seconds = self._close_after_records(threads=1)
+        self.assertEqual(exit_code, 1)
+        self.assertLess(seconds, STOP_LIMIT_S)
+
+    def test_close_stops_parallel_run(self):
+        exit_code, seconds = self._close_after_records(threads=4)
+        self.assertEqual(exit_code, 1)
+        self.assertLess(seconds, STOP_LIMIT_S)
+
+
+if __name__ == "__main__":
+    unittest.main()